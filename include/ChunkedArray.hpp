@@ -0,0 +1,54 @@
+#pragma once
+#include "MemoryStats.hpp"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Массив блоками по CHUNK элементов: рост добавляет новый блок и не переносит
+// уже созданные элементы, ссылки на них верны до pop_back или clear. Блоки
+// создаются целиком (T нужен конструктор по умолчанию) и освобождаются
+// только в clear.
+template <typename T, size_t CHUNK_BITS = 12>
+class ChunkedArray
+{
+   public:
+    static constexpr size_t CHUNK = size_t(1) << CHUNK_BITS;
+
+    auto operator[](size_t i) -> T& { return chunks[i >> CHUNK_BITS][i & (CHUNK - 1)]; }
+    auto operator[](size_t i) const -> const T& { return chunks[i >> CHUNK_BITS][i & (CHUNK - 1)]; }
+
+    [[nodiscard]] auto size() const -> size_t { return count; }
+    [[nodiscard]] auto empty() const -> bool { return count == 0; }
+
+    auto push_back(const T& value) -> T&
+    {
+        if (count == chunks.size() * CHUNK) chunks.push_back(std::make_unique<T[]>(CHUNK));
+        T& slot = (*this)[count++];
+        slot = value;
+        return slot;
+    }
+
+    // освободившийся элемент сбрасывается в T()
+    void pop_back() { (*this)[--count] = T(); }
+
+    void resize(size_t size, const T& value = T())
+    {
+        while (count > size) pop_back();
+        while (count < size) push_back(value);
+    }
+
+    void clear()
+    {
+        chunks.clear();
+        count = 0;
+    }
+
+    [[nodiscard]] auto memoryBytes() const -> size_t
+    {
+        return chunks.size() * CHUNK * sizeof(T) + vectorBytes(chunks);
+    }
+
+   private:
+    std::vector<std::unique_ptr<T[]>> chunks;
+    size_t count = 0;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include "Edge.hpp"
+#include "MemoryStats.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Индекс видимости для отрисовки: по прямоугольнику экрана отдаёт вершины и
+// рёбра, которые могут в него попасть. Вершины лежат в плотной сетке по
+// рамке графа, ребро - на уровне сетки с ячейками base * 2^level, где оно
+// помещается в ячейку, в ячейке своей середины. Строится сортировкой
+// подсчётом; запрос обходит только ячейки под прямоугольником. Пока вершины
+// и рёбра не покидают своих ячеек, сдвиги не требуют перестройки (update).
+class CullingIndex
+{
+   public:
+    // учитываются первые nodeCount вершин и рёбра между ними
+    void build(const std::vector<float>& xs, const std::vector<float>& ys, size_t nodeCount,
+               const std::vector<Edge>& edges);
+    // позиции того же графа теперь в xs, ys, и сдвинулись только movedNodes и
+    // рёбра movedEdges; false, если кто-то из них ушёл из своей ячейки или
+    // ребро перестало в неё помещаться - тогда нужен build
+    auto update(const std::vector<float>& xs, const std::vector<float>& ys,
+                const std::vector<int>& movedNodes, const std::vector<int>& movedEdges) -> bool;
+    // прямоугольник расширяется на margin; порядок результата не определён
+    void query(float minX, float minY, float maxX, float maxY, float margin,
+               std::vector<int>& nodesOut, std::vector<int>& edgesOut) const;
+
+    [[nodiscard]] auto memoryBytes() const -> size_t;
+
+   private:
+    struct Grid
+    {
+        float cellSize = 1.F;
+        int32_t width = 0, height = 0;
+        std::vector<uint32_t> start;
+        std::vector<int> items;
+    };
+
+    void setup(Grid& grid, float cellSize) const;
+    [[nodiscard]] auto cellOf(const Grid& grid, float x, float y) const -> uint32_t;
+
+    const std::vector<float>* xs = nullptr;
+    const std::vector<float>* ys = nullptr;
+    const std::vector<Edge>* edges = nullptr;
+    float originX = 0, originY = 0, extentX = 0, extentY = 0;
+    Grid nodeGrid;
+    std::vector<Grid> edgeLevels;
+    std::vector<uint32_t> nodeCell;
+    std::vector<uint32_t> edgeCell;
+    // уровень ребра или UINT8_MAX, если его конца нет среди nodeCount вершин
+    std::vector<uint8_t> edgeLevel;
+};
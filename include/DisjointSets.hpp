@@ -0,0 +1,30 @@
+#pragma once
+#include "MemoryStats.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Система непересекающихся множеств: объединение по размеру и сокращение
+// путей делением пополам, так что find и unite почти за O(1) (обратная
+// функция Аккермана). Разделять множества она не умеет.
+class DisjointSets
+{
+   public:
+    void reset(size_t count);
+    auto add() -> int;
+
+    // представитель множества; меняется при объединениях
+    auto find(int x) -> int;
+    // false, если x и y уже были в одном множестве
+    auto unite(int x, int y) -> bool;
+
+    [[nodiscard]] auto size() const -> size_t { return parent.size(); }
+    [[nodiscard]] auto setCount() const -> size_t { return sets; }
+
+    [[nodiscard]] auto memoryBytes() const -> size_t;
+
+   private:
+    std::vector<int> parent;
+    std::vector<uint32_t> setSize;
+    size_t sets = 0;
+};
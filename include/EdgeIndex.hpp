@@ -0,0 +1,39 @@
+#pragma once
+#include "Edge.hpp"
+#include "MemoryStats.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Хеш-множество неупорядоченных пар вершин с открытой адресацией.
+// Пара хранится как упакованный ключ (min << 32) | max.
+class EdgeIndex
+{
+   public:
+    auto insert(int firstNodeId, int secondNodeId) -> bool;
+    // false, если такой пары не было
+    auto erase(int firstNodeId, int secondNodeId) -> bool;
+    [[nodiscard]] auto contains(int firstNodeId, int secondNodeId) const -> bool;
+
+    void reserve(size_t count);
+    void clear();
+    [[nodiscard]] auto size() const -> size_t { return count; }
+
+    // таблица слотов как есть, для сохранения в файл и загрузки без вставок;
+    // assign отказывается от таблицы, которая не могла получиться у insert
+    [[nodiscard]] auto slotData() const -> const std::vector<uint64_t>& { return slots; }
+    auto assign(const uint64_t* table, size_t capacity, size_t expectedCount) -> bool;
+    // true, если в таблице ровно пары этих рёбер, каждая по разу и на месте,
+    // где её найдёт поиск; проверка чужой таблицы после assign
+    [[nodiscard]] auto holdsExactly(const std::vector<Edge>& edges) const -> bool;
+
+    [[nodiscard]] auto memoryBytes() const -> size_t;
+
+   private:
+    static auto key(int firstNodeId, int secondNodeId) -> uint64_t;
+    [[nodiscard]] auto slotOf(uint64_t k) const -> size_t;
+    void rehash(size_t capacity);
+
+    std::vector<uint64_t> slots;
+    size_t count = 0;
+};
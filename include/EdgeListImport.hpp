@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Импорт графа из текста. Файл отображается в память и режется на куски по
+// границам строк; куски разбираются параллельно std::from_chars прямо из
+// отображения, строки никуда не копируются. Форматы:
+//   EdgeList      "u v [w]" в строке, номера с 0; разделители - пробелы,
+//                 табуляции или запятые, комментарии начинаются с # или %
+//   MatrixMarket  "%%MatrixMarket matrix coordinate real|integer|pattern ...",
+//                 номера с 1, у pattern весов нет
+//   Dimacs        "p sp n m" и строки "a u v w" или "p edge n m" и "e u v",
+//                 номера с 1, комментарии - строки с c
+// Auto узнаёт формат по первым строкам. Направление рёбер не учитывается:
+// из повторов пары остаётся первое в файле. Число вершин из заголовка
+// (Matrix Market, DIMACS) берётся как есть, вершины без рёбер остаются. В
+// списке рёбер без заголовка номера, которых намного больше, чем концов
+// рёбер, перенумеровываются подряд.
+enum class EdgeListFormat : uint8_t
+{
+    Auto,
+    EdgeList,
+    MatrixMarket,
+    Dimacs,
+};
+
+// Ход импорта для другого потока: окно читает долю разобранных байт и может
+// попросить отмену. finished ставится последним, и после него результат готов.
+struct ImportProgress
+{
+    std::atomic<uint64_t> parsedBytes{0};
+    std::atomic<uint64_t> totalBytes{0};
+    std::atomic<bool> cancel{false};
+    std::atomic<bool> finished{false};
+
+    [[nodiscard]] auto fraction() const -> float
+    {
+        uint64_t total = totalBytes.load(std::memory_order_relaxed);
+        return total > 0 ? (float) parsedBytes.load(std::memory_order_relaxed) / (float) total
+                         : 0.F;
+    }
+};
+
+// Разобранный граф. Рёбра идут по возрастанию пары (min, max) без повторов -
+// в том порядке, в котором их пронумерует GraphCore::addEdges.
+struct ImportedGraph
+{
+    size_t nodeCount = 0;
+    std::vector<std::pair<int, int>> pairs;
+    // вес ребра из файла или NaN, если у него веса нет; пусто, если весов
+    // в файле нет совсем
+    std::vector<float> weights;
+    // номер вершины в файле (со сдвигом нумерации), если номера сжаты; иначе пусто
+    std::vector<int64_t> originalIds;
+    // почему импорт не удался
+    std::string error;
+};
+
+// false при ошибке чтения или разбора (текст - в out.error) и при отмене;
+// threads - сколько потоков разбирают куски
+auto importEdgeList(const std::string& path, ImportedGraph& out, unsigned threads,
+                    ImportProgress* progress = nullptr,
+                    EdgeListFormat format = EdgeListFormat::Auto) -> bool;
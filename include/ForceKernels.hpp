@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+
+// Векторные ядра сил над упакованными массивами координат. Каждая дорожка
+// считается теми же операциями, что и скалярная версия, поэтому результаты
+// всех вариантов совпадают побитово; вариант выбирается по CPU при запуске.
+struct ForceKernels
+{
+    // толчок от каждой из n соседних вершин на вершину (x, y) радиуса r;
+    // ноль, если вершины не пересекаются
+    void (*overlap)(float x, float y, float r, const float* xs, const float* ys, const float* rs,
+                    float* pushX, float* pushY, size_t n, float strength);
+
+    // сила каждой из n пружин на её первый конец (на второй действует обратная)
+    void (*springs)(const float* ax, const float* ay, const float* bx, const float* by,
+                    const float* rest, float* forceX, float* forceY, size_t n, float strength);
+
+    const char* name;
+};
+
+auto forceKernels() -> const ForceKernels&;
+auto scalarForceKernels() -> const ForceKernels&;
@@ -0,0 +1,92 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+// Законы сил раскладки. Модель - набор статических функций и констант; шаг
+// физики собирается под каждую модель отдельно (GraphCore::forceModels), так
+// что законы встраиваются во внутренние циклы без ветвлений и вызовов по
+// указателю.
+//
+//   spring(dist, rest)         сила пружины длины dist с длиной покоя rest;
+//                              положительная стягивает концы
+//   repulsion(strength, dist2) множитель вектора между вершинами в дальнем
+//                              отталкивании; strength уже умножена на массы
+//   DEGREE_WEIGHTED            масса вершины в отталкивании - степень + 1,
+//                              иначе 1
+//   REPULSION                  сила дальнего отталкивания (режим Барнса-Хата)
+//   LONG_RANGE                 дальнее отталкивание и в режиме Overlap: без
+//                              него модель не отличалась бы от другой
+//   VECTOR_SPRINGS             закон пружины - тот же, что у ForceKernels::springs
+//                              с силой SPRING, и можно взять векторное ядро
+
+// Закон Гука и отталкивание 1/d: модель по умолчанию.
+struct LinearSpring
+{
+    static constexpr const char* NAME = "linear";
+    static constexpr float SPRING = 0.02F;
+    static constexpr float REPULSION = 30.F;
+    static constexpr bool DEGREE_WEIGHTED = false;
+    static constexpr bool LONG_RANGE = false;
+    static constexpr bool VECTOR_SPRINGS = true;
+
+    static auto spring(float dist, float rest) -> float { return (dist - rest) * SPRING; }
+    static auto repulsion(float strength, float dist2) -> float { return strength / dist2; }
+};
+
+// Пружины Идса: сила растёт как логарифм растяжения, длинные рёбра не
+// выстреливают концами через весь граф.
+struct LogSpring
+{
+    static constexpr const char* NAME = "log";
+    static constexpr float SPRING = 0.02F;
+    static constexpr float REPULSION = 30.F;
+    static constexpr bool DEGREE_WEIGHTED = false;
+    static constexpr bool LONG_RANGE = false;
+    static constexpr bool VECTOR_SPRINGS = false;
+    // длина покоя снизу, чтобы логарифм не делил на ноль
+    static constexpr float MIN_REST = 1.F;
+
+    static auto spring(float dist, float rest) -> float
+    {
+        float k = std::max(rest, MIN_REST);
+        return k * std::log(dist / k) * SPRING;
+    }
+    static auto repulsion(float strength, float dist2) -> float { return strength / dist2; }
+};
+
+// Фрюхтерман-Рейнгольд: притяжение d^2/k и отталкивание k^2/d концов ребра,
+// k - длина покоя. Около k жёсткость та же, что у линейной модели. Отталкивание
+// всех пар, как в исходном алгоритме, - только в режиме Барнса-Хата.
+struct FruchtermanReingold
+{
+    static constexpr const char* NAME = "fruchterman-reingold";
+    static constexpr float SPRING = 0.02F / 3;
+    static constexpr float REPULSION = 30.F;
+    static constexpr bool DEGREE_WEIGHTED = false;
+    static constexpr bool LONG_RANGE = false;
+    static constexpr bool VECTOR_SPRINGS = false;
+    static constexpr float MIN_REST = 1.F;
+
+    static auto spring(float dist, float rest) -> float
+    {
+        float k = std::max(rest, MIN_REST);
+        return (dist * dist / k - k * k / dist) * SPRING;
+    }
+    static auto repulsion(float strength, float dist2) -> float { return strength / dist2; }
+};
+
+// ForceAtlas2: вершины отталкиваются с силой (deg_a + 1)(deg_b + 1)/d, поэтому
+// узлы-хабы расходятся, а листья остаются рядом с ними; пружины линейные, так
+// что без дальнего отталкивания это была бы линейная модель.
+struct ForceAtlas2
+{
+    static constexpr const char* NAME = "forceatlas2";
+    static constexpr float SPRING = 0.02F;
+    static constexpr float REPULSION = 10.F;
+    static constexpr bool DEGREE_WEIGHTED = true;
+    static constexpr bool LONG_RANGE = true;
+    static constexpr bool VECTOR_SPRINGS = true;
+
+    static auto spring(float dist, float rest) -> float { return (dist - rest) * SPRING; }
+    static auto repulsion(float strength, float dist2) -> float { return strength / dist2; }
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// фазы кадра; physics идёт в потоке физики, остальные - в главном
+enum class Phase : uint8_t
+{
+    Events,
+    Physics,
+    UpdateNodes,
+    Draw,
+    Display,
+};
+constexpr size_t PHASE_COUNT = 5;
+
+// Замеры фаз кадра: у каждой фазы кольцо последних SAMPLES интервалов.
+// Пишет в кольцо фазы только один поток, читать можно из любого; чтение во
+// время записи может захватить полузаписанный самый старый интервал, для
+// процентилей это неважно. Выключенный профайлер не читает часы: Scope
+// проверяет один флаг.
+class FrameProfiler
+{
+   public:
+    static constexpr size_t SAMPLES = 1024;
+
+    // миллисекунды по последним count интервалам фазы
+    struct Stats
+    {
+        size_t count = 0;
+        double p50 = 0, p95 = 0, p99 = 0, max = 0;
+    };
+
+    // интервал от конструктора до finish (или деструктора); owner может быть nullptr
+    class Scope
+    {
+       public:
+        Scope(FrameProfiler* owner, Phase phase)
+            : profiler(owner && owner->enabled() ? owner : nullptr), phase(phase)
+        {
+            if (profiler) start = now();
+        }
+        ~Scope() { finish(); }
+        Scope(const Scope&) = delete;
+        auto operator=(const Scope&) -> Scope& = delete;
+
+        void finish()
+        {
+            if (!profiler) return;
+            profiler->record(phase, start, now());
+            profiler = nullptr;
+        }
+
+       private:
+        FrameProfiler* profiler;
+        Phase phase;
+        int64_t start = 0;
+    };
+
+    FrameProfiler();
+
+    [[nodiscard]] auto enabled() const -> bool { return on.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { on.store(enabled, std::memory_order_relaxed); }
+
+    // start, end - наносекунды steady_clock
+    void record(Phase phase, int64_t start, int64_t end);
+    [[nodiscard]] auto stats(Phase phase) const -> Stats;
+
+    // те же интервалы в формате Chrome trace (chrome://tracing, Perfetto);
+    // false при ошибке записи
+    auto exportTrace(const std::string& path) const -> bool;
+
+    static auto name(Phase phase) -> const char*;
+    static auto now() -> int64_t
+    {
+        auto time = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    }
+
+   private:
+    struct Ring
+    {
+        std::array<std::atomic<int64_t>, SAMPLES> start{};
+        std::array<std::atomic<int64_t>, SAMPLES> duration{};
+        std::atomic<uint64_t> written{0};
+    };
+
+    struct Sample
+    {
+        int64_t start, duration;
+    };
+    // последние интервалы фазы, от старых к новым
+    void snapshot(Phase phase, std::vector<Sample>& out) const;
+
+    std::array<Ring, PHASE_COUNT> rings;
+    std::atomic<bool> on{false};
+    int64_t origin;
+};
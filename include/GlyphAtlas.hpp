@@ -0,0 +1,40 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <string>
+
+// Метрики глифов одного размера шрифта, загруженные заранее. Текст из этих
+// символов раскладывается в общий массив треугольников без sf::Text, а
+// текстурой служит страница шрифта для этого размера.
+class GlyphAtlas
+{
+   public:
+    void load(const sf::Font& font, unsigned characterSize, const std::string& charset);
+    [[nodiscard]] auto isLoadedFor(const sf::Font& font) const -> bool
+    {
+        return loadedFont == &font;
+    }
+    [[nodiscard]] auto texture() const -> const sf::Texture&;
+
+    [[nodiscard]] auto bounds(const std::string& text) const -> sf::FloatRect;
+    void append(sf::VertexArray& triangles, const std::string& text, sf::Vector2f offset,
+                sf::Color color) const;
+
+   private:
+    struct Glyph
+    {
+        float advance = 0;
+        sf::FloatRect bounds;
+        sf::FloatRect textureRect;
+        int slot = -1;
+    };
+
+    static constexpr size_t MAX_CHARSET = 16;
+
+    [[nodiscard]] auto kerning(char previous, char current) const -> float;
+
+    const sf::Font* loadedFont = nullptr;
+    unsigned characterSize = 0;
+    std::array<Glyph, 128> glyphs;
+    std::array<std::array<float, MAX_CHARSET>, MAX_CHARSET> kernings{};
+};
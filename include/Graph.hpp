@@ -1,27 +1,160 @@
 #pragma once
-#include "Edge.hpp"
+#include "ChunkedArray.hpp"
+#include "CullingIndex.hpp"
+#include "GlyphAtlas.hpp"
+#include "GraphCore.hpp"
+#include "MemoryStats.hpp"
 #include "Node.hpp"
+#include "PhysicsThread.hpp"
 #include "utils.hpp"
 #include <SFML/Graphics.hpp>
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
+// Слой отрисовки поверх GraphCore: только читает позиции и радиусы из ядра.
+// Рисуется только то, что попало в вид окна; чем мельче масштаб, тем меньше
+// деталей: сначала пропадают подписи, потом круги становятся точками, потом
+// вершины и рёбра сливаются в ячейки экрана. Всё видимое собирается в
+// несколько общих массивов вершин, которые переиспользуются между кадрами.
+// Пока вид не меняется, неподвижная часть графа рисуется один раз в кэш, а
+// каждый кадр поверх него - только движущиеся вершины и их рёбра.
 class Graph
 {
    public:
-    std::vector<Node> nodes;
-    std::vector<Edge> edges;
+    GraphCore core;
+    // блоками: при росте записи вершин не переезжают
+    ChunkedArray<Node> nodes;
 
-    void addNode(const sf::Vector2f& position, const sf::Font& font);
+    void addNode(const sf::Vector2f& position);
     void addEdge(int firstNodeId, int secondNodeId);
+    // пачками, как GraphCore::addNodes / addEdges
+    auto addNodes(const float* xs, const float* ys, size_t count) -> int;
+    auto addEdges(const std::pair<int, int>* pairs, size_t count) -> size_t;
+    // как в GraphCore: на место удалённой вершины встаёт последняя
+    void removeNode(int id);
+    void removeEdge(int edgeId);
 
-    bool hasEdge(int firstNodeId, int secondNodeId);
+    bool hasEdge(int firstNodeId, int secondNodeId) const;
+
+    auto position(int id) const -> sf::Vector2f { return {core.posX[id], core.posY[id]}; }
+    void setPosition(int id, sf::Vector2f position);
+
+    auto pickNode(sf::Vector2f point) const -> int { return core.pickNode(point.x, point.y); }
+    auto pickEdge(sf::Vector2f point, float tolerance = 10.f) const -> int
+    {
+        return core.pickEdge(point.x, point.y, tolerance);
+    }
 
     void updatePhysics(int draggedId);
     void updateNodes();
+    // физика в своём потоке: рисуем по её последнему кадру; вершины, которых
+    // ещё нет в кадре, появятся после следующего шага
+    void updateNodes(const PhysicsThread::Frame& frame);
+
+    // перетаскиваемая вершина (-1 - нет): она и соседи сразу рисуются поверх кэша
+    void setDraggedNode(int id);
 
-    void draw(sf::RenderWindow& window, const sf::Font& font, int editingEdge = -1,
+    // цвет вершин, выделение и веса рёбер рисуются в кэше неподвижной части,
+    // поэтому меняются только здесь: кэш сбрасывается, если что-то поменялось
+    void setNodeColor(int id, sf::Color color);
+    void setEdgeSelected(int edgeId, bool selected);
+    // выделены ровно рёбра edgeIds
+    void selectEdges(const std::vector<int>& edgeIds);
+    // выделены ровно рёбра вершины id
+    void selectIncidentEdges(int id) { selectEdges(core.incidentEdgesOf(id)); }
+    void clearSelection();
+    void setEdgeWeight(int edgeId, float weight);
+
+    // видимая область и масштаб берутся из текущего вида window
+    void draw(sf::RenderTarget& window, const sf::Font& font, int editingEdge = -1,
               const std::string& weightInput = "");
 
     void clear();
+
+    auto save(const std::string& path) const -> bool { return core.save(path); }
+    auto load(const std::string& path) -> bool;
+    // граф из текста, разобранный importEdgeList (EdgeListImport.hpp)
+    void importGraph(const ImportedGraph& imported);
+
+    // ядро плюс записи вершин, подписи рёбер, индекс отсечения и буферы кадра
+    [[nodiscard]] auto memoryStats() const -> MemoryStats;
+
+   private:
+    // подпись веса ребра пересобирается только при смене целой части веса
+    struct EdgeLabel
+    {
+        int value = 0;
+        std::string text;
+        sf::Vector2f origin;
+    };
+
+    // откуда берутся позиции и радиусы для отрисовки: массивы ядра или кадр
+    // потока физики
+    const std::vector<float>* viewX = &core.posX;
+    const std::vector<float>* viewY = &core.posY;
+    const std::vector<float>* viewRadius = &core.radius;
+    size_t visibleNodes = 0;
+
+    auto drawPosition(int id) const -> sf::Vector2f { return {(*viewX)[id], (*viewY)[id]}; }
+    // после замены графа в ядре целиком
+    void resetNodes();
+    void rebuildCulling();
+    // индекс отсечения догоняет сдвиг вершин moved за O(сдвинутых и их рёбер)
+    void refreshCulling(const std::vector<float>& xs, const std::vector<float>& ys,
+                        const std::vector<int>& moved);
+    void markMoved(int id);
+    auto isMoving(int id) const -> bool
+    {
+        return (size_t) id < movingMark.size() && movingMark[id] != 0;
+    }
+    void collectMoving();
+    auto buildStaticLayer(sf::RenderTarget& window, float scale, int editingEdge) -> bool;
+    void drawStaticLayer(sf::RenderTarget& window);
+    void drawItems(sf::RenderTarget& target, const std::vector<int>& edgeIds,
+                   const std::vector<int>& nodeIds, float scale, int editingEdge,
+                   const std::string& weightInput);
+    void drawCircles(sf::RenderTarget& target, const std::vector<int>& nodeIds, bool labels);
+    void drawAggregated(sf::RenderTarget& window, sf::Vector2f topLeft, float scale);
+
+    // индекс строится по тем же позициям, что и рисуются; перестраивается
+    // перед запросом, если вершина из кадра физики ушла из своей ячейки или
+    // изменились вершины и рёбра; правки рёбер сбрасывают его явно: удаление
+    // и добавление в одном кадре не меняют их числа
+    CullingIndex culling;
+    uint64_t shownStep = UINT64_MAX;
+    bool cullingDirty = true;
+    size_t culledNodes = 0;
+    std::vector<int> movedEdgeIds;
+    std::vector<int> visibleIds;
+    std::vector<int> visibleEdges;
+    std::vector<uint64_t> binKeys;
+
+    // кэш неподвижной части: годен, пока тот же вид, то же редактируемое
+    // ребро и ни одна вершина вне движущегося набора не сдвинулась
+    sf::RenderTexture staticLayer;
+    bool staticValid = false;
+    sf::Vector2f shownCenter, shownSize;
+    int staticEditingEdge = -1;
+    size_t staticVisibleNodes = 0;
+    // счётчик кадров для Node::movedAt и сколько вершин сдвинулось в последнем
+    uint32_t updateStep = 0;
+    size_t movedCount = 0;
+    int draggedId = -1;
+    std::vector<uint8_t> movingMark;
+    std::vector<int> movingIds;
+    std::vector<int> movingEdges;
+    std::vector<int> staticIds;
+    std::vector<int> staticEdges;
+
+    GlyphAtlas weightGlyphs;
+    GlyphAtlas nodeGlyphs;
+    std::vector<EdgeLabel> edgeLabels;
+    std::string nodeLabel;
+    sf::VertexArray edgeLines{sf::Lines};
+    sf::VertexArray labelTriangles{sf::Triangles};
+    sf::VertexArray nodeQuads{sf::Quads};
+    sf::VertexArray circleTriangles{sf::Triangles};
+    sf::VertexArray nodeLabelTriangles{sf::Triangles};
 };
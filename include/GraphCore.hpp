@@ -0,0 +1,278 @@
+#pragma once
+#include "DisjointSets.hpp"
+#include "Edge.hpp"
+#include "EdgeIndex.hpp"
+#include "EdgeListImport.hpp"
+#include "ForceKernels.hpp"
+#include "ForceModel.hpp"
+#include "GraphFile.hpp"
+#include "HandleTable.hpp"
+#include "MemoryStats.hpp"
+#include "MultilevelLayout.hpp"
+#include "PickIndex.hpp"
+#include "QuadTree.hpp"
+#include "ShortestPath.hpp"
+#include "SpanningForest.hpp"
+#include "SpatialGrid.hpp"
+#include "ThreadPool.hpp"
+#include "Vec2.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+constexpr float NODE_RADIUS_MAX = 15.f;
+constexpr float NODE_GROWTH_SPEED = 0.5f;
+
+enum class LayoutMode
+{
+    Overlap,    // только раздвигание пересекающихся вершин и пружины (кроме LONG_RANGE)
+    BarnesHut,  // плюс дальнее отталкивание через квадродерево
+};
+
+// Ядро графа без SFML: координаты и радиусы вершин хранятся отдельными
+// массивами, физика раскладки работает только с ними.
+class GraphCore
+{
+   public:
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> radius;
+    std::vector<uint8_t> growing;
+    std::vector<Edge> edges;
+
+    // полный перебор пар в проходе отталкивания (для сверки с сеткой)
+    bool bruteForceOverlap = false;
+
+    LayoutMode layoutMode = LayoutMode::Overlap;
+    float barnesHutTheta = 0.8F;
+
+    // параллельный шаг: силы всех проходов считаются по одному снимку позиций
+    // в отдельные буферы и применяются разом; результат не зависит от числа потоков
+    bool parallelStep = false;
+    unsigned threadCount = std::max(1U, std::thread::hardware_concurrency());
+    // скалярные ядра вместо SSE/AVX2 (для сверки)
+    bool scalarKernels = false;
+
+    // Модели сил (ForceModel.hpp): шаг физики собран под каждую при
+    // компиляции, здесь выбирается по имени. Первая в списке - по умолчанию.
+    struct ForceModelKernel
+    {
+        const char* name;
+        void (GraphCore::*step)(int draggedId);
+        void (MultilevelLayout::*layout)(const std::vector<Edge>& edges, std::vector<float>& xs,
+                                         std::vector<float>& ys, ThreadPool& pool);
+    };
+    static auto forceModels() -> const std::vector<ForceModelKernel>&;
+    // false, если модели с таким именем нет; тогда модель не меняется
+    auto setForceModel(const std::string& name) -> bool;
+    [[nodiscard]] auto forceModelName() const -> const char* { return forceModel->name; }
+
+    // засыпание: вершина, которая долго почти не двигалась, замирает и не
+    // участвует в шаге, пока её не разбудят правка, перетаскивание или
+    // движение соседа; когда спят все, step ничего не делает
+    bool sleeping = true;
+    [[nodiscard]] auto awakeCount() const -> size_t { return posX.size() - sleepingCount; }
+    // сумма квадратов сдвигов вершин за последний шаг
+    [[nodiscard]] auto energy() const -> float { return stepEnergy; }
+    void wakeAll();
+
+    // вершины, у которых с последнего clearChanged изменились позиция или
+    // радиус (и новые); каждая один раз, порядок не определён
+    [[nodiscard]] auto changedNodes() const -> const std::vector<int>& { return changedIds; }
+    void clearChanged();
+
+    auto addNode(float x, float y) -> int;
+    void addEdge(int firstNodeId, int secondNodeId);
+    // Пакетная вставка для импорта и генерации: память под всю пачку берётся
+    // сразу, а большая пачка (от 1/BULK_REINDEX_RATIO графа) не вносится в
+    // индекс выбора по одной, он пересобирается на следующем шаге.
+    // addNodes возвращает номер первой новой вершины.
+    auto addNodes(const float* xs, const float* ys, size_t count) -> int;
+    // Пары сортируются и повторы убираются одним проходом, уже существующие
+    // рёбра и пары с несуществующими вершинами пропускаются. Новые рёбра
+    // получают номера по возрастанию пары (min, max); возвращает их число.
+    auto addEdges(const std::pair<int, int>* pairs, size_t count) -> size_t;
+    // вес менять только так: от него зависит индекс кратчайших путей
+    void setEdgeWeight(int edgeId, float weight);
+
+    [[nodiscard]] auto hasEdge(int firstNodeId, int secondNodeId) const -> bool;
+    [[nodiscard]] auto nodeCount() const -> size_t { return posX.size(); }
+    // рёбра вершины (петля - один раз)
+    [[nodiscard]] auto incidentEdgesOf(int id) const -> const std::vector<int>&
+    {
+        return incidentEdges[id];
+    }
+    [[nodiscard]] auto position(int id) const -> Vec2 { return {posX[id], posY[id]}; }
+    void moveNode(int id, float x, float y);
+
+    // Номера вершин и рёбер плотные и меняются при удалении: на место
+    // удалённого встаёт последний. Ссылка переживает такие перестановки,
+    // а после удаления своего элемента разрешается в -1.
+    [[nodiscard]] auto nodeHandle(int id) const -> NodeHandle { return nodeHandles.handleOf(id); }
+    [[nodiscard]] auto nodeId(NodeHandle handle) const -> int { return nodeHandles.find(handle); }
+    [[nodiscard]] auto edgeHandle(int id) const -> EdgeHandle { return edgeHandles.handleOf(id); }
+    [[nodiscard]] auto edgeId(EdgeHandle handle) const -> int { return edgeHandles.find(handle); }
+    // вершина удаляется вместе со своими рёбрами; время - от числа этих рёбер
+    void removeNode(int id);
+    void removeEdge(int edgeId);
+
+    // первая по номеру вершина под точкой / ребро ближе tolerance; -1, если нет
+    [[nodiscard]] auto pickNode(float x, float y) const -> int;
+    [[nodiscard]] auto pickEdge(float x, float y, float tolerance) const -> int;
+
+    // длина кратчайшего пути по весам рёбер (бесконечность, если пути нет),
+    // рёбра пути по порядку - в path; A* по умолчанию, иначе Дейкстра
+    auto shortestPath(int from, int to, std::vector<int>& path, bool useAStar = true) -> float;
+
+    // компоненты связности: множества сливаются прямо в addEdge, а после
+    // удалений (разделить множество нельзя) пересобираются при первом запросе
+    auto componentOf(int id) -> int;
+    auto connected(int firstNodeId, int secondNodeId) -> bool;
+    auto componentCount() -> size_t;
+    // минимальный остовный лес по весам рёбер на threadCount потоках: рёбра
+    // по возрастанию номеров - в forest; возвращает суммарный вес
+    auto minimumSpanningForest(std::vector<int>& forest) -> float;
+
+    // раскладка с нуля через огрубление графа (MultilevelLayout.hpp) по
+    // выбранной модели сил на threadCount потоках: для больших графов, которые
+    // шагами распутываются слишком долго; потом step доводит её как обычно
+    void layoutMultilevel();
+    // Та же раскладка без блокировки ядра на всё время счёта: снимок рёбер,
+    // позиций и модели берётся и применяется под блокировкой, а run идёт в
+    // любом потоке со своим пулом. Позиции не применяются (false), если число
+    // вершин за это время изменилось.
+    struct LayoutJob
+    {
+        std::vector<Edge> edges;
+        std::vector<float> x, y;
+        const ForceModelKernel* model = nullptr;
+        MultilevelLayout layout;
+
+        void run(ThreadPool& pool) { (layout.*model->layout)(edges, x, y, pool); }
+    };
+    void snapshotLayout(LayoutJob& job) const;
+    auto applyLayout(const LayoutJob& job) -> bool;
+
+    void step(int draggedId);
+    // растут только вершины из списка растущих: в покое проход ничего не стоит
+    void growNodes();
+    [[nodiscard]] auto growingCount() const -> size_t { return growingIds.size(); }
+
+    void clear();
+
+    // сколько занимают массивы ядра, индексы и рабочие буферы (MemoryStats.hpp)
+    [[nodiscard]] auto memoryStats() const -> MemoryStats;
+
+    // двоичный формат из GraphFile.hpp; false при ошибке записи или чтения,
+    // неудачная загрузка граф не меняет. Ядро хранит свои vector, поэтому
+    // load копирует массивы из отображения, а не работает с ним на месте
+    auto save(const std::string& path) const -> bool;
+    auto load(const std::string& path) -> bool;
+    // заменяет граф разобранным из текста (EdgeListImport.hpp): вершины
+    // случайно разбрасываются по квадрату, площадь которого растёт с их
+    // числом; вес ребра - из файла, а без него - длина, как в addEdge
+    void importGraph(const ImportedGraph& imported);
+
+   private:
+    void resolveOverlapsBruteForce(int draggedId);
+    auto resolveOverlapsGrid(int draggedId, float skin) -> bool;
+    auto pushApart(size_t i, size_t j, int draggedId) -> float;
+    template <typename Model>
+    void stepWith(int draggedId);
+    template <typename Model>
+    [[nodiscard]] auto longRange() const -> bool
+    {
+        return Model::LONG_RANGE || layoutMode == LayoutMode::BarnesHut;
+    }
+    template <typename Model>
+    void applyLongRangeRepulsion(int draggedId);
+    template <typename Model>
+    void applySprings(int draggedId);
+    template <typename Model>
+    void buildRepulsionTree(const std::vector<float>& xs, const std::vector<float>& ys);
+
+    // упакованные координаты соседей одной вершины для ядра отталкивания
+    struct NeighborBatch
+    {
+        std::vector<int> ids;
+        std::vector<float> x, y, r, pushX, pushY;
+    };
+
+    void refreshPickIndex();
+    void invalidatePickIndex();
+    void markChanged(int id);
+    // после раскладки, переставившей все вершины
+    void markAllMoved();
+    void unlistChanged(int id);
+    void wakeNode(int id);
+    void updateSleep(int draggedId);
+
+    template <typename Model>
+    void stepParallel(int draggedId);
+    auto threadPool() -> ThreadPool&;
+    void refreshComponents();
+    template <typename Model>
+    void computeSpringForces(const ForceKernels& kernels);
+    template <typename Model>
+    auto accumulateForce(int id, const ForceKernels& kernels, NeighborBatch& batch) const -> Vec2;
+
+    const ForceModelKernel* forceModel = &forceModels()[0];
+
+    EdgeIndex edgeIndex;
+    PickIndex pickIndex;
+    // после загрузки сетка строится заново на первом шаге, до этого выбор перебором
+    bool pickIndexDirty = false;
+    SpatialGrid overlapGrid;
+    QuadTree repulsionTree;
+    // массы вершин в дальнем отталкивании для моделей с DEGREE_WEIGHTED
+    std::vector<float> repulsionMass;
+    std::vector<float> startX;
+    std::vector<float> startY;
+    std::vector<float> travelled;
+    std::vector<Vec2> forces;
+    std::vector<int> candidates;
+    std::vector<uint64_t> overlapPairs;
+
+    std::vector<uint8_t> asleep;
+    std::vector<uint16_t> quietSteps;
+    std::vector<float> stepStartX;
+    std::vector<float> stepStartY;
+    std::vector<int> awakeIds;
+    std::vector<int> movingIds;
+    size_t sleepingCount = 0;
+    float stepEnergy = 0.F;
+
+    // вершины с growing != 0
+    std::vector<int> growingIds;
+
+    std::vector<int> changedIds;
+    // место вершины в changedIds или -1
+    std::vector<int32_t> changedSlot;
+
+    // рёбра каждой вершины (петля - один раз), по возрастанию номеров, пока
+    // ничего не удаляли
+    std::vector<std::vector<int>> incidentEdges;
+    HandleTable<NodeHandle> nodeHandles;
+    HandleTable<EdgeHandle> edgeHandles;
+
+    std::unique_ptr<ThreadPool> pool;
+    std::vector<float> deltaX;
+    std::vector<float> deltaY;
+    std::vector<float> springAX, springAY, springBX, springBY, springRest;
+    std::vector<float> springFX, springFY;
+
+    ShortestPath paths;
+    bool pathsDirty = true;
+    // растёт при каждом сдвиге вершин шагом, moveNode, раскладкой, очисткой
+    // или загрузкой: по нему A* понимает, что масштаб оценки устарел
+    uint64_t positionsVersion = 0;
+
+    DisjointSets components;
+    bool componentsDirty = false;
+    SpanningForest spanningForest;
+    MultilevelLayout multilevel;
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Двоичный формат графа. За заголовком идут секции фиксированной раскладки,
+// каждая с границы GRAPH_FILE_ALIGNMENT: posX, posY, radius (float на
+// вершину), рёбра (GraphFileEdge) и таблица EdgeIndex (uint64_t на слот).
+// Порядок байт - родной для машины, проверяется по byteOrder. Файл
+// отображается в память; массивы вершин и таблица копируются целиком, а
+// рёбра переписываются в Edge по одному: номера вершин надо проверить, а у
+// Edge в памяти есть ещё поле выделения. Таблица сверяется с рёбрами.
+constexpr char GRAPH_FILE_MAGIC[8] = {'G', 'R', 'A', 'P', 'H', 'B', 'I', 'N'};
+constexpr uint32_t GRAPH_FILE_VERSION = 1;
+constexpr uint32_t GRAPH_FILE_BYTE_ORDER = 0x01020304;
+constexpr uint64_t GRAPH_FILE_ALIGNMENT = 64;
+
+struct GraphFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t nodeCount;
+    uint64_t edgeCount;
+    uint64_t slotCount;
+    uint64_t posXOffset;
+    uint64_t posYOffset;
+    uint64_t radiusOffset;
+    uint64_t edgesOffset;
+    uint64_t slotsOffset;
+    uint64_t fileSize;
+};
+
+struct GraphFileEdge
+{
+    int32_t firstNodeId;
+    int32_t secondNodeId;
+    float weight;
+};
+
+// Раскладка секций для заданных размеров; fileSize - полный размер файла.
+auto graphFileLayout(uint64_t nodeCount, uint64_t edgeCount, uint64_t slotCount)
+    -> GraphFileHeader;
+
+// Файл графа, отображённый в память только для чтения. Секции доступны
+// указателями прямо в отображение, пока объект открыт.
+class MappedGraphFile
+{
+   public:
+    MappedGraphFile() = default;
+    ~MappedGraphFile();
+
+    MappedGraphFile(const MappedGraphFile&) = delete;
+    auto operator=(const MappedGraphFile&) -> MappedGraphFile& = delete;
+
+    // false, если файла нет, он обрезан или это не граф этой версии
+    auto open(const std::string& path) -> bool;
+    void close();
+
+    [[nodiscard]] auto nodeCount() const -> size_t { return (size_t) header->nodeCount; }
+    [[nodiscard]] auto edgeCount() const -> size_t { return (size_t) header->edgeCount; }
+    [[nodiscard]] auto slotCount() const -> size_t { return (size_t) header->slotCount; }
+
+    [[nodiscard]] auto posX() const -> const float* { return section<float>(header->posXOffset); }
+    [[nodiscard]] auto posY() const -> const float* { return section<float>(header->posYOffset); }
+    [[nodiscard]] auto radius() const -> const float*
+    {
+        return section<float>(header->radiusOffset);
+    }
+    [[nodiscard]] auto edges() const -> const GraphFileEdge*
+    {
+        return section<GraphFileEdge>(header->edgesOffset);
+    }
+    [[nodiscard]] auto slots() const -> const uint64_t*
+    {
+        return section<uint64_t>(header->slotsOffset);
+    }
+
+   private:
+    template <typename T>
+    [[nodiscard]] auto section(uint64_t offset) const -> const T*
+    {
+        return reinterpret_cast<const T*>(static_cast<const char*>(data) + offset);
+    }
+
+    void* data = nullptr;
+    size_t size = 0;
+    const GraphFileHeader* header = nullptr;
+};
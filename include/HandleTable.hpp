@@ -0,0 +1,106 @@
+#pragma once
+#include "MemoryStats.hpp"
+#include <cstdint>
+#include <vector>
+
+// Поколенческая ссылка на элемент: номер слота и поколение слота на момент
+// выдачи. После удаления элемента поколение слота растёт, и старая ссылка
+// перестаёт разрешаться, даже если слот уже занят новым элементом.
+template <typename Tag>
+struct Handle
+{
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+
+    auto operator==(const Handle& other) const -> bool
+    {
+        return slot == other.slot && generation == other.generation;
+    }
+    auto operator!=(const Handle& other) const -> bool { return !(*this == other); }
+};
+
+using NodeHandle = Handle<struct NodeTag>;
+using EdgeHandle = Handle<struct EdgeTag>;
+
+// Слоты ссылок для плотного массива, который удаляет перестановкой: на место
+// удалённого встаёт последний элемент. Освободившиеся слоты переиспользуются,
+// так что таблица не растёт при долгой правке.
+template <typename HandleType>
+class HandleTable
+{
+   public:
+    // ссылка на новый элемент в конце массива
+    auto add() -> HandleType
+    {
+        uint32_t slot;
+        if (freeSlots.empty())
+        {
+            slot = (uint32_t) slotIndex.size();
+            slotIndex.push_back(0);
+            generations.push_back(0);
+        }
+        else
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        slotIndex[slot] = (uint32_t) indexSlot.size();
+        indexSlot.push_back(slot);
+        return {slot, generations[slot]};
+    }
+
+    // элемент index удалён, последний переехал на его место
+    void remove(int index)
+    {
+        uint32_t slot = indexSlot[index];
+        generations[slot]++;
+        freeSlots.push_back(slot);
+        indexSlot[index] = indexSlot.back();
+        slotIndex[indexSlot[index]] = (uint32_t) index;
+        indexSlot.pop_back();
+    }
+
+    // -1, если элемент по ссылке удалён
+    [[nodiscard]] auto find(HandleType handle) const -> int
+    {
+        if (handle.slot >= slotIndex.size() || generations[handle.slot] != handle.generation)
+            return -1;
+        return (int) slotIndex[handle.slot];
+    }
+
+    [[nodiscard]] auto handleOf(int index) const -> HandleType
+    {
+        uint32_t slot = indexSlot[index];
+        return {slot, generations[slot]};
+    }
+
+    // после clear старые ссылки не разрешаются: поколения сохраняются
+    void clear()
+    {
+        for (uint32_t slot : indexSlot)
+        {
+            generations[slot]++;
+            freeSlots.push_back(slot);
+        }
+        indexSlot.clear();
+    }
+
+    void reserve(size_t count)
+    {
+        indexSlot.reserve(count);
+        slotIndex.reserve(count);
+        generations.reserve(count);
+    }
+
+    [[nodiscard]] auto memoryBytes() const -> size_t
+    {
+        return vectorBytes(slotIndex) + vectorBytes(generations) + vectorBytes(freeSlots) +
+               vectorBytes(indexSlot);
+    }
+
+   private:
+    std::vector<uint32_t> slotIndex;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint32_t> indexSlot;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Память графа в байтах по ёмкости контейнеров (без служебных данных
+// аллокатора). nodeBytes и edgeBytes - собственные данные вершин и рёбер,
+// indexBytes - индексы, которые пересобираются из них, scratchBytes - рабочие
+// буферы алгоритмов, живущие между вызовами.
+struct MemoryStats
+{
+    size_t nodes = 0, edges = 0;
+    size_t nodeBytes = 0, edgeBytes = 0, indexBytes = 0, scratchBytes = 0;
+
+    [[nodiscard]] auto bytesPerNode() const -> double
+    {
+        return nodes == 0 ? 0 : (double) nodeBytes / (double) nodes;
+    }
+    [[nodiscard]] auto bytesPerEdge() const -> double
+    {
+        return edges == 0 ? 0 : (double) edgeBytes / (double) edges;
+    }
+    [[nodiscard]] auto totalBytes() const -> size_t
+    {
+        return nodeBytes + edgeBytes + indexBytes + scratchBytes;
+    }
+};
+
+template <typename T>
+auto vectorBytes(const std::vector<T>& values) -> size_t
+{
+    return values.capacity() * sizeof(T);
+}
+
+// вектор векторов: внешний массив и все внутренние
+template <typename T>
+auto vectorBytes(const std::vector<std::vector<T>>& lists) -> size_t
+{
+    size_t bytes = lists.capacity() * sizeof(std::vector<T>);
+    for (const auto& list : lists) bytes += vectorBytes(list);
+    return bytes;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "Edge.hpp"
+#include "MemoryStats.hpp"
+#include "QuadTree.hpp"
+#include "ThreadPool.hpp"
+#include <cstdint>
+#include <vector>
+
+// Многоуровневая раскладка. Граф огрубляется: вершины сливаются по
+// паросочетанию, а вершина без свободных соседей - в самого лёгкого соседа,
+// пока не останется COARSEST_NODES вершин. Грубый граф раскладывается
+// пружинами и отталкиванием Барнса-Хата по законам модели сил (ForceModel.hpp),
+// затем каждый уровень получает позиции от своего грубого и уточняется теми же
+// силами. Длина грубого ребра растёт с размером сливаемых групп, а
+// отталкивание - с квадратом длины, поэтому масштаб сохраняется по уровням.
+class MultilevelLayout
+{
+   public:
+    // xs, ys на входе - текущие позиции (центры групп - начальная раскладка
+    // грубого уровня), на выходе - новые; на исходном уровне силы те же, что у
+    // шага GraphCore с моделью Model
+    template <typename Model = LinearSpring>
+    void run(const std::vector<Edge>& edges, std::vector<float>& xs, std::vector<float>& ys,
+             ThreadPool& pool);
+
+    [[nodiscard]] auto memoryBytes() const -> size_t;
+
+   private:
+    struct Level
+    {
+        std::vector<float> x, y, mass;
+        // средняя по группе степень исходных вершин + 1: масса в отталкивании
+        // моделей с DEGREE_WEIGHTED
+        std::vector<float> charge;
+        // смежность CSR: соседи и длины рёбер до них
+        std::vector<uint32_t> start;
+        std::vector<int> neighbors;
+        std::vector<float> rest;
+        // вершина следующего, более грубого уровня
+        std::vector<int> parent;
+        float meanRest = 1.F;
+    };
+
+    void coarsen(Level& fine, Level& coarse);
+    template <typename Model>
+    void refine(Level& level, int iterations, float temperature, ThreadPool& pool);
+
+    std::vector<Level> levels;
+    QuadTree tree;
+    std::vector<int> order;
+    std::vector<float> deltaX, deltaY;
+};
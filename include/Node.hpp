@@ -1,17 +1,15 @@
 #pragma once
 #include <SFML/Graphics.hpp>
-#include <string>
+#include <cstdint>
 
-class Node
-{
-   public:
-    sf::Vector2f position;
-    float radius;
-    bool IsGrowing;
-    sf::CircleShape shape;
-    sf::Text label;
+const sf::Color NODE_COLOR(100, 150, 250);
 
-    Node(const sf::Vector2f& position, int index, const sf::Font& font);
-    void update();
-    void draw(sf::RenderWindow& window);
+// Вершина на экране. Положение и радиус берутся из GraphCore или кадра
+// физики, подпись - номер вершины, а круги и подписи всех вершин собираются
+// в общие массивы вершин Graph при отрисовке, так что своего у вершины
+// остаются цвет и номер кадра, когда она последний раз сдвигалась.
+struct Node
+{
+    sf::Color color = NODE_COLOR;
+    uint32_t movedAt = 0;
 };
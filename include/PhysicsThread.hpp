@@ -0,0 +1,122 @@
+#pragma once
+#include "FrameProfiler.hpp"
+#include "GraphCore.hpp"
+#include "SpscQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Физика графа в отдельном потоке с фиксированным шагом по времени. После
+// каждого шага позиции и радиусы копируются в тройной буфер, и отрисовка
+// забирает последний готовый кадр, не дожидаясь физики. В кадр копируются
+// только вершины, изменившиеся с прошлой записи в этот же буфер. Перетаскивание
+// приходит через очередь без блокировок; любые другие обращения к ядру из
+// других потоков - только под lock(). Когда все вершины спят, ничто не растёт
+// и никого не тянут, поток не просыпается по таймеру, а ждёт правки под lock()
+// или нового перетаскивания.
+class PhysicsThread
+{
+   public:
+    static constexpr double DEFAULT_STEP_SECONDS = 1.0 / 90;
+
+    struct Frame
+    {
+        std::vector<float> posX, posY, radius;
+        // вершины, сдвинувшиеся или выросшие после кадра, который отрисовка
+        // забрала предыдущим (пропущенные ею кадры тоже учтены)
+        std::vector<int> dirtyIds;
+        uint64_t step = 0;
+    };
+
+    // шаги физики пишутся в profiler, если он задан
+    explicit PhysicsThread(GraphCore& core, double stepSeconds = DEFAULT_STEP_SECONDS,
+                           FrameProfiler* profiler = nullptr);
+    ~PhysicsThread();
+
+    PhysicsThread(const PhysicsThread&) = delete;
+    auto operator=(const PhysicsThread&) -> PhysicsThread& = delete;
+
+    // для потока отрисовки: вершина тянется в (x, y); пустая или устаревшая
+    // ссылка - отпустили. false, если очередь полна (физика отстала больше
+    // чем на DRAG_QUEUE событий)
+    auto drag(NodeHandle node, float x, float y) -> bool;
+    // кадр остаётся неизменным до следующего вызова latestFrame
+    auto latestFrame() -> const Frame&;
+
+    // блокировка ядра; при снятии будит уснувший поток: под ней могли править граф
+    class Lock
+    {
+       public:
+        Lock() = default;
+        explicit Lock(PhysicsThread& owner) : owner(&owner), guard(owner.mutex) {}
+        ~Lock() { unlock(); }
+        Lock(Lock&& other) noexcept = default;
+        auto operator=(Lock&& other) noexcept -> Lock&
+        {
+            unlock();
+            owner = other.owner;
+            guard = std::move(other.guard);
+            return *this;
+        }
+
+        void unlock()
+        {
+            if (!guard.owns_lock()) return;
+            owner->requests.fetch_add(1);
+            guard.unlock();
+            owner->wakeup.notify_one();
+        }
+
+       private:
+        PhysicsThread* owner = nullptr;
+        std::unique_lock<std::mutex> guard;
+    };
+
+    auto lock() -> Lock { return Lock(*this); }
+
+   private:
+    static constexpr size_t DRAG_QUEUE = 64;
+
+    struct DragEvent
+    {
+        NodeHandle node;
+        float x, y;
+    };
+
+    void run();
+    void copyChanged(Frame& frame);
+    void collectDirty(Frame& frame);
+    void publish();
+
+    GraphCore& core;
+    std::chrono::duration<double> stepTime;
+    FrameProfiler* profiler;
+    std::mutex mutex;
+    SpscQueue<DragEvent, DRAG_QUEUE> drags;
+    // сколько раз поток просили проснуться (Lock и drag); спящий поток ждёт,
+    // пока счётчик не сдвинется
+    std::condition_variable wakeup;
+    std::atomic<uint64_t> requests{0};
+    std::atomic<bool> idle{false};
+    // последнее перетаскивание из drag: отпускание повторно не отправляется
+    NodeHandle sentNode;
+
+    // кадры: back пишет физика, front читает отрисовка, ready - последний
+    // готовый; в ready рядом с номером кадра хранится флаг FRESH
+    Frame frames[3];
+    std::atomic<unsigned> ready{1};
+    unsigned back = 0;
+    unsigned front = 2;
+    // изменения со времени последнего забранного кадра; только для потока физики
+    std::vector<int> carriedIds;
+    std::vector<uint8_t> carriedMark;
+    // вершины, изменившиеся после последней записи в кадр k; только для потока физики
+    std::vector<int> staleIds[3];
+    std::vector<uint8_t> staleMark[3];
+
+    std::atomic<bool> stopping{false};
+    std::thread worker;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include "MemoryStats.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Сетка для выбора вершин и рёбер мышью. Вершина лежит в ячейке своего
+// центра. Ребро хранится на уровне сетки с ячейками CELL_SIZE * 2^level,
+// где его концы отстоят не больше чем на MAX_EDGE_SPAN ячеек, во всех
+// ячейках полосы между ними, так что даже длинное ребро занимает не больше
+// трёх десятков ячеек. При движении вершины ребро
+// перерегистрируется, только когда конец сменил ячейку; старые записи
+// помечаются устаревшими по номеру версии и вычищаются пачкой.
+class PickIndex
+{
+   public:
+    static constexpr float CELL_SIZE = 64.F;
+    static constexpr int32_t MAX_EDGE_SPAN = 4;
+
+    void clear();
+    void addNode(int id, float x, float y);
+    auto moveNode(int id, float x, float y) -> bool;
+    void addEdge(int id, int firstNodeId, int secondNodeId);
+    // для удаления перестановкой: рёбра вершины удаляются раньше неё, а
+    // переименование занимает номер, который уже освобождён
+    void eraseNode(int id);
+    void renameNode(int from, int to);
+    void eraseEdge(int id);
+    void renameEdge(int from, int to);
+
+    void queryNodes(float x, float y, std::vector<int>& out) const;
+    // false, если кандидатов больше limit (тогда дешевле перебрать все рёбра)
+    auto queryEdges(float x, float y, std::vector<int>& out, size_t limit) const -> bool;
+
+    [[nodiscard]] auto memoryBytes() const -> size_t;
+
+   private:
+    struct EdgeEntry
+    {
+        int id;
+        uint32_t version;
+    };
+
+    struct Cell
+    {
+        std::vector<int> nodes;
+        std::vector<EdgeEntry> edges;
+        uint32_t staleEdges = 0;
+    };
+
+    static auto cellOf(float x, float y) -> uint64_t;
+    auto coveredCells(int edgeId, std::vector<uint64_t>& out) const -> size_t;
+    void insertEdge(int edgeId);
+    void removeEdge(int edgeId);
+
+    std::vector<std::unordered_map<uint64_t, Cell>> levels;
+    std::vector<uint64_t> nodeCell;
+    std::vector<std::vector<int>> nodeEdges;
+    std::vector<std::pair<int, int>> edgeEnds;
+    std::vector<uint32_t> edgeVersion;
+    std::vector<uint64_t> scratch;
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include "FrameProfiler.hpp"
+#include <SFML/Graphics.hpp>
+
+// Таблица процентилей фаз кадра поверх окна; рисуется в координатах окна.
+class ProfilerOverlay
+{
+   public:
+    void draw(sf::RenderTarget& target, const sf::Font& font, const FrameProfiler& profiler);
+
+   private:
+    sf::RectangleShape background;
+    sf::Text text;
+};
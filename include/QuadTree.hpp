@@ -0,0 +1,96 @@
+#pragma once
+#include "ForceModel.hpp"
+#include "MemoryStats.hpp"
+#include "Vec2.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Квадродерево Барнса-Хата: в каждой ячейке хранится суммарная масса и центр
+// масс, дальние ячейки при расчёте отталкивания считаются одной точкой.
+class QuadTree
+{
+   public:
+    // masses - массы вершин для моделей с DEGREE_WEIGHTED, иначе у всех 1
+    void build(const std::vector<float>& xs, const std::vector<float>& ys,
+               const std::vector<float>* masses = nullptr);
+    // закон отталкивания - из модели ForceModel.hpp; определён здесь, чтобы
+    // встраиваться во внутренние циклы шага
+    template <typename Model = LinearSpring>
+    [[nodiscard]] auto repulsion(int id, float theta, float strength) const -> Vec2;
+
+    [[nodiscard]] auto memoryBytes() const -> size_t;
+
+   private:
+    static constexpr int MAX_DEPTH = 24;
+    static constexpr float MIN_DIST_SQUARED = 0.01F;
+
+    struct Cell
+    {
+        float centerX, centerY, halfSize;
+        float massX, massY, mass;
+        int firstChild;
+        uint32_t begin, end;
+    };
+
+    void subdivide(int cellId, int depth);
+
+    const std::vector<float>* xs = nullptr;
+    const std::vector<float>* ys = nullptr;
+    const std::vector<float>* masses = nullptr;
+    std::vector<Cell> cells;
+    std::vector<int> order;
+};
+
+template <typename Model>
+auto QuadTree::repulsion(int id, float theta, float strength) const -> Vec2
+{
+    Vec2 force;
+    if (cells.empty()) return force;
+
+    auto& x = *xs;
+    auto& y = *ys;
+    float px = x[id], py = y[id];
+    if constexpr (Model::DEGREE_WEIGHTED) strength *= (*masses)[id];
+    std::array<int, 4 * MAX_DEPTH + 4> stack;
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        const Cell& cell = cells[stack[--top]];
+        if (cell.mass == 0) continue;
+
+        if (cell.firstChild < 0)
+        {
+            for (uint32_t k = cell.begin; k < cell.end; k++)
+            {
+                if (order[k] == id) continue;
+                float dx = px - x[order[k]], dy = py - y[order[k]];
+                float dist2 = dx * dx + dy * dy;
+                float s = strength;
+                if constexpr (Model::DEGREE_WEIGHTED) s *= (*masses)[order[k]];
+                if (dist2 > MIN_DIST_SQUARED)
+                {
+                    force.x += dx * Model::repulsion(s, dist2);
+                    force.y += dy * Model::repulsion(s, dist2);
+                }
+            }
+            continue;
+        }
+
+        float dx = px - cell.massX, dy = py - cell.massY;
+        float dist2 = dx * dx + dy * dy;
+        float size = 2 * cell.halfSize;
+        if (size * size < theta * theta * dist2)
+        {
+            force.x += dx * Model::repulsion(strength * cell.mass, dist2);
+            force.y += dy * Model::repulsion(strength * cell.mass, dist2);
+        }
+        else
+        {
+            for (int q = 0; q < 4; q++) stack[top++] = cell.firstChild + q;
+        }
+    }
+    return force;
+}
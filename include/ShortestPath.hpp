@@ -0,0 +1,66 @@
+#pragma once
+#include "Edge.hpp"
+#include "MemoryStats.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Кратчайшие пути по весам рёбер: Дейкстра и A* с евклидовой оценкой.
+// Смежность хранится в CSR, куча и метки вершин живут между запросами,
+// так что повторный запрос ничего не выделяет. Веса должны быть неотрицательны.
+class ShortestPath
+{
+   public:
+    void build(const std::vector<Edge>& edges, size_t nodeCount);
+
+    // длина пути или бесконечность, если пути нет; рёбра пути пишутся в path от from к to
+    auto dijkstra(int from, int to, std::vector<int>& path) -> float;
+    // positionsVersion меняется при каждом сдвиге вершин: пока он тот же,
+    // масштаб оценки берётся из прошлого запроса
+    auto aStar(int from, int to, const std::vector<float>& xs, const std::vector<float>& ys,
+               uint64_t positionsVersion, std::vector<int>& path) -> float;
+
+    [[nodiscard]] auto memoryBytes() const -> size_t;
+
+   private:
+    struct Arc
+    {
+        int target;
+        int edge;
+        float weight;
+    };
+
+    // всё, что поиск знает о вершине, в одной строке кэша
+    struct Label
+    {
+        float distance;
+        uint32_t query;
+        int parent;
+        int parentEdge;
+    };
+
+    struct HeapEntry
+    {
+        float key;
+        float distance;
+        int node;
+    };
+
+    auto search(int from, int to, const float* xs, const float* ys, float scale,
+                std::vector<int>& path) -> float;
+    void beginQuery();
+
+    std::vector<uint32_t> start;
+    std::vector<Arc> arcs;
+    // концы и веса рёбер подряд, для оценки A*
+    std::vector<int> edgeFirst, edgeSecond;
+    std::vector<float> edgeWeights;
+    // масштаб оценки A* (0 - оценки нет, только Дейкстра) и для каких позиций
+    float heuristicScale = 0.F;
+    uint64_t scaleVersion = 0;
+    bool scaleValid = false;
+
+    std::vector<Label> labels;
+    std::vector<HeapEntry> heap;
+    uint32_t query = 0;
+};
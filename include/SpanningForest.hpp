@@ -0,0 +1,32 @@
+#pragma once
+#include "DisjointSets.hpp"
+#include "Edge.hpp"
+#include "MemoryStats.hpp"
+#include "ThreadPool.hpp"
+#include <cstdint>
+#include <vector>
+
+// Минимальный остовный лес алгоритмом Борувки. Рёбра каждой вершины
+// заранее параллельно сортируются по весу. В каждом раунде вершина двигает
+// свой указатель мимо рёбер, ставших внутренними (внутренними они останутся),
+// и первое внешнее - её кандидат; по компоненте берётся лучший кандидат, и
+// компоненты сливаются. Раундов не больше log2(n). При равных весах легче
+// ребро с меньшим номером, поэтому результат не зависит от числа потоков.
+class SpanningForest
+{
+   public:
+    // рёбра леса по возрастанию номеров - в forest; возвращает суммарный вес
+    auto build(const std::vector<Edge>& edges, const std::vector<std::vector<int>>& incidentEdges,
+               ThreadPool& pool, std::vector<int>& forest) -> float;
+
+    [[nodiscard]] auto memoryBytes() const -> size_t;
+
+   private:
+    DisjointSets sets;
+    std::vector<uint32_t> start;
+    std::vector<int> sortedEdges;
+    std::vector<uint32_t> cursor;
+    std::vector<int> roots;
+    std::vector<int> nodeBest;
+    std::vector<int> componentBest;
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include "MemoryStats.hpp"
+#include <cstdint>
+#include <vector>
+
+// Равномерная сетка с хешированием ячеек: точки раскладываются по корзинам
+// сортировкой подсчётом, запрос возвращает всех соседей из 3x3 ячеек.
+class SpatialGrid
+{
+   public:
+    void build(const std::vector<float>& xs, const std::vector<float>& ys, float cellSize);
+    void query(float x, float y, std::vector<int>& out) const;
+
+    [[nodiscard]] auto memoryBytes() const -> size_t;
+
+   private:
+    [[nodiscard]] auto cellOf(float coord) const -> int32_t;
+    [[nodiscard]] auto bucketOf(int32_t cx, int32_t cy) const -> uint32_t;
+
+    float cellSize = 1.F;
+    uint32_t mask = 0;
+    std::vector<uint32_t> bucketStart;
+    std::vector<int> items;
+    std::vector<uint32_t> itemBucket;
+};
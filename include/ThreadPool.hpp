@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков для parallelFor: диапазон режется на куски, которые разбирают
+// рабочие потоки и вызывающий поток. Вызов возвращается, когда все куски готовы.
+class ThreadPool
+{
+   public:
+    using Body = std::function<void(size_t begin, size_t end)>;
+
+    explicit ThreadPool(unsigned threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+
+    [[nodiscard]] auto size() const -> unsigned { return (unsigned) workers.size() + 1; }
+    void parallelFor(size_t count, const Body& body);
+
+   private:
+    void workerLoop();
+    void runChunks();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const Body* job = nullptr;
+    size_t jobCount = 0;
+    size_t chunkSize = 1;
+    std::atomic<size_t> nextIndex{0};
+    size_t pending = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+// Минимальный двумерный вектор для ядра, которое не зависит от SFML.
+struct Vec2
+{
+    float x = 0.F;
+    float y = 0.F;
+};
@@ -0,0 +1,193 @@
+#include "CullingIndex.hpp"
+#include <algorithm>
+#include <cmath>
+
+// ячейка не мельче этого и сетка не шире MAX_GRID_SIDE ячеек по стороне,
+// даже если вершины вытянуты в линию или разлетелись далеко
+constexpr float MIN_CELL_SIZE = 64.F;
+constexpr float MAX_GRID_SIDE = 4096.F;
+// рамка графа не больше base * MAX_GRID_SIDE, дальше уровни не нужны
+constexpr uint8_t MAX_LEVEL = 13;
+
+namespace
+{
+auto clampCell(float cell, int32_t size) -> int32_t
+{
+    return (int32_t) std::max(0.F, std::min((float) (size - 1), std::floor(cell)));
+}
+}  // namespace
+
+void CullingIndex::setup(Grid& grid, float cellSize) const
+{
+    grid.cellSize = cellSize;
+    grid.width = (int32_t) (extentX / cellSize) + 1;
+    grid.height = (int32_t) (extentY / cellSize) + 1;
+    grid.start.assign((size_t) grid.width * grid.height + 1, 0);
+}
+
+auto CullingIndex::cellOf(const Grid& grid, float x, float y) const -> uint32_t
+{
+    int32_t cx = clampCell((x - originX) / grid.cellSize, grid.width);
+    int32_t cy = clampCell((y - originY) / grid.cellSize, grid.height);
+    return (uint32_t) (cy * grid.width + cx);
+}
+
+void CullingIndex::build(const std::vector<float>& xValues, const std::vector<float>& yValues,
+                         size_t nodeCount, const std::vector<Edge>& edgeList)
+{
+    xs = &xValues;
+    ys = &yValues;
+    edges = &edgeList;
+    edgeLevels.clear();
+    nodeGrid = Grid();
+    nodeCell.clear();
+    edgeLevel.clear();
+    if (nodeCount == 0) return;
+
+    auto [minX, maxX] = std::minmax_element(xValues.begin(), xValues.begin() + nodeCount);
+    auto [minY, maxY] = std::minmax_element(yValues.begin(), yValues.begin() + nodeCount);
+    originX = *minX;
+    originY = *minY;
+    extentX = *maxX - *minX;
+    extentY = *maxY - *minY;
+
+    // в среднем по вершине на ячейку
+    float base = std::sqrt(extentX * extentY / (float) nodeCount);
+    base = std::max({base, MIN_CELL_SIZE, std::max(extentX, extentY) / MAX_GRID_SIDE});
+
+    setup(nodeGrid, base);
+    nodeCell.resize(nodeCount);
+    for (size_t i = 0; i < nodeCount; i++)
+    {
+        nodeCell[i] = cellOf(nodeGrid, xValues[i], yValues[i]);
+        nodeGrid.start[nodeCell[i] + 1]++;
+    }
+    for (size_t c = 0; c + 1 < nodeGrid.start.size(); c++)
+        nodeGrid.start[c + 1] += nodeGrid.start[c];
+    nodeGrid.items.resize(nodeCount);
+    std::vector<uint32_t> fill(nodeGrid.start.begin(), nodeGrid.start.end() - 1);
+    for (size_t i = 0; i < nodeCount; i++) nodeGrid.items[fill[nodeCell[i]]++] = (int) i;
+
+    // уровень ребра - первый, где его рамка не больше ячейки
+    edgeLevel.assign(edgeList.size(), UINT8_MAX);
+    size_t levelCount = 0;
+    for (size_t e = 0; e < edgeList.size(); e++)
+    {
+        auto a = (size_t) edgeList[e].firstNodeId, b = (size_t) edgeList[e].secondNodeId;
+        if (a >= nodeCount || b >= nodeCount) continue;
+        float span =
+            std::max(std::fabs(xValues[a] - xValues[b]), std::fabs(yValues[a] - yValues[b]));
+        uint8_t level = 0;
+        for (float cell = base; cell < span && level < MAX_LEVEL; cell *= 2) level++;
+        edgeLevel[e] = level;
+        levelCount = std::max(levelCount, (size_t) level + 1);
+    }
+
+    edgeLevels.resize(levelCount);
+    edgeCell.resize(edgeList.size());
+    for (size_t level = 0; level < levelCount; level++)
+    {
+        setup(edgeLevels[level], base * (float) (1U << level));
+    }
+    for (size_t e = 0; e < edgeList.size(); e++)
+    {
+        if (edgeLevel[e] == UINT8_MAX) continue;
+        Grid& grid = edgeLevels[edgeLevel[e]];
+        int a = edgeList[e].firstNodeId, b = edgeList[e].secondNodeId;
+        edgeCell[e] = cellOf(grid, (xValues[a] + xValues[b]) / 2, (yValues[a] + yValues[b]) / 2);
+        grid.start[edgeCell[e] + 1]++;
+    }
+    for (Grid& grid : edgeLevels)
+    {
+        for (size_t c = 0; c + 1 < grid.start.size(); c++) grid.start[c + 1] += grid.start[c];
+        grid.items.resize(grid.start.back());
+    }
+    std::vector<std::vector<uint32_t>> fills(levelCount);
+    for (size_t level = 0; level < levelCount; level++)
+    {
+        fills[level].assign(edgeLevels[level].start.begin(), edgeLevels[level].start.end() - 1);
+    }
+    for (size_t e = 0; e < edgeList.size(); e++)
+    {
+        if (edgeLevel[e] == UINT8_MAX) continue;
+        edgeLevels[edgeLevel[e]].items[fills[edgeLevel[e]][edgeCell[e]]++] = (int) e;
+    }
+}
+
+// Ребро на своём уровне находится, пока его середина в той же ячейке, а рамка
+// не больше ячейки: запрос расширяет прямоугольник на половину ячейки.
+auto CullingIndex::update(const std::vector<float>& xValues, const std::vector<float>& yValues,
+                          const std::vector<int>& movedNodes, const std::vector<int>& movedEdges)
+    -> bool
+{
+    xs = &xValues;
+    ys = &yValues;
+    for (int i : movedNodes)
+    {
+        // вершин за nodeCount в индексе нет
+        if ((size_t) i >= nodeCell.size()) continue;
+        if (cellOf(nodeGrid, xValues[i], yValues[i]) != nodeCell[i]) return false;
+    }
+    for (int e : movedEdges)
+    {
+        if ((size_t) e >= edgeLevel.size()) return false;
+        if (edgeLevel[e] == UINT8_MAX) continue;
+        const Grid& grid = edgeLevels[edgeLevel[e]];
+        auto a = (size_t) (*edges)[e].firstNodeId, b = (size_t) (*edges)[e].secondNodeId;
+        float span =
+            std::max(std::fabs(xValues[a] - xValues[b]), std::fabs(yValues[a] - yValues[b]));
+        if (span > grid.cellSize && edgeLevel[e] < MAX_LEVEL) return false;
+        float midX = (xValues[a] + xValues[b]) / 2, midY = (yValues[a] + yValues[b]) / 2;
+        if (cellOf(grid, midX, midY) != edgeCell[e]) return false;
+    }
+    return true;
+}
+
+void CullingIndex::query(float minX, float minY, float maxX, float maxY, float margin,
+                         std::vector<int>& nodesOut, std::vector<int>& edgesOut) const
+{
+    if (nodeGrid.items.empty()) return;
+    minX -= margin;
+    minY -= margin;
+    maxX += margin;
+    maxY += margin;
+
+    // обход ячеек, задевающих прямоугольник, расширенный ещё на reach
+    auto visit = [&](const Grid& grid, float reach, auto&& test) {
+        int32_t x0 = clampCell((minX - reach - originX) / grid.cellSize, grid.width);
+        int32_t x1 = clampCell((maxX + reach - originX) / grid.cellSize, grid.width);
+        int32_t y0 = clampCell((minY - reach - originY) / grid.cellSize, grid.height);
+        int32_t y1 = clampCell((maxY + reach - originY) / grid.cellSize, grid.height);
+        for (int32_t cy = y0; cy <= y1; cy++)
+        {
+            uint32_t row = (uint32_t) (cy * grid.width);
+            for (uint32_t k = grid.start[row + x0]; k < grid.start[row + x1 + 1]; k++)
+                test(grid.items[k]);
+        }
+    };
+
+    visit(nodeGrid, 0.F, [&](int i) {
+        float x = (*xs)[i], y = (*ys)[i];
+        if (x >= minX && x <= maxX && y >= minY && y <= maxY) nodesOut.push_back(i);
+    });
+
+    for (const Grid& grid : edgeLevels)
+    {
+        visit(grid, grid.cellSize / 2, [&](int e) {
+            int a = (*edges)[e].firstNodeId, b = (*edges)[e].secondNodeId;
+            float ax = (*xs)[a], ay = (*ys)[a], bx = (*xs)[b], by = (*ys)[b];
+            if (std::max(ax, bx) >= minX && std::min(ax, bx) <= maxX &&
+                std::max(ay, by) >= minY && std::min(ay, by) <= maxY)
+                edgesOut.push_back(e);
+        });
+    }
+}
+
+auto CullingIndex::memoryBytes() const -> size_t
+{
+    size_t bytes = vectorBytes(nodeGrid.start) + vectorBytes(nodeGrid.items) +
+                   vectorBytes(edgeLevels) + vectorBytes(nodeCell) + vectorBytes(edgeCell) +
+                   vectorBytes(edgeLevel);
+    for (const Grid& grid : edgeLevels) bytes += vectorBytes(grid.start) + vectorBytes(grid.items);
+    return bytes;
+}
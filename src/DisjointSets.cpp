@@ -0,0 +1,46 @@
+#include "DisjointSets.hpp"
+#include <numeric>
+#include <utility>
+
+void DisjointSets::reset(size_t count)
+{
+    parent.resize(count);
+    std::iota(parent.begin(), parent.end(), 0);
+    setSize.assign(count, 1);
+    sets = count;
+}
+
+auto DisjointSets::add() -> int
+{
+    parent.push_back((int) parent.size());
+    setSize.push_back(1);
+    sets++;
+    return parent.back();
+}
+
+auto DisjointSets::find(int x) -> int
+{
+    while (parent[x] != x)
+    {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+auto DisjointSets::unite(int x, int y) -> bool
+{
+    x = find(x);
+    y = find(y);
+    if (x == y) return false;
+    if (setSize[x] < setSize[y]) std::swap(x, y);
+    parent[y] = x;
+    setSize[x] += setSize[y];
+    sets--;
+    return true;
+}
+
+auto DisjointSets::memoryBytes() const -> size_t
+{
+    return vectorBytes(parent) + vectorBytes(setSize);
+}
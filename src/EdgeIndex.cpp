@@ -0,0 +1,156 @@
+#include "EdgeIndex.hpp"
+#include <algorithm>
+
+constexpr uint64_t EMPTY_SLOT = ~uint64_t(0);
+constexpr size_t MIN_CAPACITY = 16;
+
+auto EdgeIndex::key(int firstNodeId, int secondNodeId) -> uint64_t
+{
+    auto lo = (uint32_t) std::min(firstNodeId, secondNodeId);
+    auto hi = (uint32_t) std::max(firstNodeId, secondNodeId);
+    return ((uint64_t) lo << 32) | hi;
+}
+
+auto EdgeIndex::slotOf(uint64_t k) const -> size_t
+{
+    // splitmix64
+    k ^= k >> 30;
+    k *= 0xbf58476d1ce4e5b9ULL;
+    k ^= k >> 27;
+    k *= 0x94d049bb133111ebULL;
+    k ^= k >> 31;
+    return (size_t) k & (slots.size() - 1);
+}
+
+auto EdgeIndex::insert(int firstNodeId, int secondNodeId) -> bool
+{
+    if (2 * (count + 1) > slots.size()) rehash(std::max(MIN_CAPACITY, 2 * slots.size()));
+
+    uint64_t k = key(firstNodeId, secondNodeId);
+    size_t mask = slots.size() - 1;
+    for (size_t s = slotOf(k);; s = (s + 1) & mask)
+    {
+        if (slots[s] == k) return false;
+        if (slots[s] == EMPTY_SLOT)
+        {
+            slots[s] = k;
+            count++;
+            return true;
+        }
+    }
+}
+
+// Без надгробий: следующие за освободившимся слотом ключи цепочки сдвигаются
+// назад, если их место по хешу не лежит между освободившимся слотом и ними.
+auto EdgeIndex::erase(int firstNodeId, int secondNodeId) -> bool
+{
+    if (count == 0) return false;
+
+    uint64_t k = key(firstNodeId, secondNodeId);
+    size_t mask = slots.size() - 1;
+    size_t hole = slotOf(k);
+    while (slots[hole] != k)
+    {
+        if (slots[hole] == EMPTY_SLOT) return false;
+        hole = (hole + 1) & mask;
+    }
+
+    for (size_t s = (hole + 1) & mask; slots[s] != EMPTY_SLOT; s = (s + 1) & mask)
+    {
+        size_t home = slotOf(slots[s]);
+        if (((s - home) & mask) >= ((s - hole) & mask))
+        {
+            slots[hole] = slots[s];
+            hole = s;
+        }
+    }
+    slots[hole] = EMPTY_SLOT;
+    count--;
+    return true;
+}
+
+auto EdgeIndex::contains(int firstNodeId, int secondNodeId) const -> bool
+{
+    if (count == 0) return false;
+
+    uint64_t k = key(firstNodeId, secondNodeId);
+    size_t mask = slots.size() - 1;
+    for (size_t s = slotOf(k);; s = (s + 1) & mask)
+    {
+        if (slots[s] == k) return true;
+        if (slots[s] == EMPTY_SLOT) return false;
+    }
+}
+
+void EdgeIndex::reserve(size_t n)
+{
+    size_t capacity = MIN_CAPACITY;
+    while (capacity < 2 * n) capacity <<= 1;
+    if (capacity > slots.size()) rehash(capacity);
+}
+
+auto EdgeIndex::assign(const uint64_t* table, size_t capacity, size_t expectedCount) -> bool
+{
+    if (capacity == 0)
+    {
+        if (expectedCount != 0) return false;
+        slots.clear();
+        count = 0;
+        return true;
+    }
+    if (capacity < MIN_CAPACITY || (capacity & (capacity - 1)) != 0) return false;
+    if (2 * expectedCount > capacity) return false;
+    auto used = std::count_if(table, table + capacity, [](uint64_t k) { return k != EMPTY_SLOT; });
+    if ((size_t) used != expectedCount) return false;
+
+    slots.assign(table, table + capacity);
+    count = expectedCount;
+    return true;
+}
+
+auto EdgeIndex::holdsExactly(const std::vector<Edge>& edges) const -> bool
+{
+    if (edges.size() != count) return false;
+    std::vector<bool> found(slots.size(), false);
+    size_t mask = slots.size() - 1;
+    for (const Edge& edge : edges)
+    {
+        uint64_t k = key(edge.firstNodeId, edge.secondNodeId);
+        size_t s = slotOf(k);
+        while (slots[s] != k)
+        {
+            if (slots[s] == EMPTY_SLOT) return false;
+            s = (s + 1) & mask;
+        }
+        // одна пара у двух рёбер
+        if (found[s]) return false;
+        found[s] = true;
+    }
+    return true;
+}
+
+void EdgeIndex::clear()
+{
+    std::fill(slots.begin(), slots.end(), EMPTY_SLOT);
+    count = 0;
+}
+
+void EdgeIndex::rehash(size_t capacity)
+{
+    std::vector<uint64_t> old(capacity, EMPTY_SLOT);
+    old.swap(slots);
+
+    size_t mask = slots.size() - 1;
+    for (uint64_t k : old)
+    {
+        if (k == EMPTY_SLOT) continue;
+        size_t s = slotOf(k);
+        while (slots[s] != EMPTY_SLOT) s = (s + 1) & mask;
+        slots[s] = k;
+    }
+}
+
+auto EdgeIndex::memoryBytes() const -> size_t
+{
+    return vectorBytes(slots);
+}
@@ -0,0 +1,493 @@
+#include "EdgeListImport.hpp"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+// кусок разбора: мелкий, чтобы ход обновлялся часто и потоки кончали вместе
+constexpr size_t CHUNK_BYTES = 4 << 20;
+// ход и отмена проверяются раз в столько строк
+constexpr size_t PROGRESS_LINES = 1 << 16;
+constexpr float NO_WEIGHT = std::numeric_limits<float>::quiet_NaN();
+constexpr std::string_view MATRIX_MARKET_BANNER = "%%MatrixMarket";
+// номера в списке рёбер без заголовка редкие, если их больше, чем SPARSE_IDS
+// концов рёбер на номер, плюс SPARSE_SLACK: вершины без рёбер заняли бы всю память
+constexpr size_t SPARSE_IDS = 4;
+constexpr size_t SPARSE_SLACK = 1 << 16;
+
+namespace
+{
+// текстовый файл, отображённый в память только для чтения; пустой файл не
+// отображается, и begin() == end()
+class MappedText
+{
+   public:
+    MappedText() = default;
+    ~MappedText()
+    {
+        if (data != nullptr) munmap(data, size);
+    }
+    MappedText(const MappedText&) = delete;
+    auto operator=(const MappedText&) -> MappedText& = delete;
+
+    auto open(const std::string& path) -> bool
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info = {};
+        bool ok = fstat(fd, &info) == 0;
+        size = ok ? (size_t) info.st_size : 0;
+        if (size > 0)
+        {
+            data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                data = nullptr;
+                ok = false;
+            }
+            else
+            {
+                madvise(data, size, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+        return ok;
+    }
+
+    [[nodiscard]] auto begin() const -> const char* { return static_cast<const char*>(data); }
+    [[nodiscard]] auto end() const -> const char* { return begin() + (data ? size : 0); }
+
+   private:
+    void* data = nullptr;
+    size_t size = 0;
+};
+
+// как читать строки рёбер после заголовка
+struct Syntax
+{
+    EdgeListFormat format = EdgeListFormat::EdgeList;
+    // номер первой вершины в файле
+    int64_t base = 0;
+    // номера после сдвига должны быть меньше; -1 - число вершин берётся по
+    // наибольшему номеру
+    int64_t nodeCount = -1;
+    bool weighted = true;
+};
+
+struct Entry
+{
+    // пара (min, max), как ключ в GraphCore::addEdges
+    uint64_t key;
+    float weight;
+};
+
+struct Chunk
+{
+    std::vector<Entry> entries;
+    int64_t maxId = -1;
+    bool hasWeights = false;
+    // начало строки, которую не удалось разобрать
+    const char* errorAt = nullptr;
+    const char* error = nullptr;
+};
+
+auto isBlank(char c) -> bool
+{
+    return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+auto skipBlanks(const char* p, const char* end) -> const char*
+{
+    while (p < end && isBlank(*p)) p++;
+    return p;
+}
+
+auto lineEnd(const char* p, const char* end) -> const char*
+{
+    const void* newline = std::memchr(p, '\n', (size_t) (end - p));
+    return newline ? static_cast<const char*>(newline) : end;
+}
+
+auto nextLine(const char* eol, const char* end) -> const char*
+{
+    return eol < end ? eol + 1 : end;
+}
+
+// слово до пробела; p сдвигается за него
+auto nextToken(const char*& p, const char* eol) -> std::string_view
+{
+    p = skipBlanks(p, eol);
+    const char* start = p;
+    while (p < eol && !isBlank(*p)) p++;
+    return {start, (size_t) (p - start)};
+}
+
+template <typename T>
+auto parseToken(const char*& p, const char* eol, T& value) -> bool
+{
+    std::string_view token = nextToken(p, eol);
+    auto [last, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+    return ec == std::errc() && last == token.data() + token.size() && !token.empty();
+}
+
+auto startsWith(const char* p, const char* end, std::string_view prefix) -> bool
+{
+    return (size_t) (end - p) >= prefix.size() && std::memcmp(p, prefix.data(), prefix.size()) == 0;
+}
+
+auto isComment(char c, const Syntax& syntax) -> bool
+{
+    return syntax.format == EdgeListFormat::Dimacs ? c == 'c' : c == '#' || c == '%';
+}
+
+// Первые строки: формат, нумерация и начало рёбер в body. false, если
+// заголовок не разобран.
+auto parseHeader(const char* begin, const char* end, EdgeListFormat format, Syntax& syntax,
+                 const char*& body, std::string& error) -> bool
+{
+    const char* first = begin;
+    while (first < end && (isBlank(*first) || *first == '\n')) first++;
+    if (format == EdgeListFormat::Auto)
+    {
+        const char* p = first;
+        while (p < end && (*p == '#' || (*p == '%' && !startsWith(p, end, MATRIX_MARKET_BANNER))))
+        {
+            p = nextLine(lineEnd(p, end), end);
+            p = skipBlanks(p, end);
+        }
+        bool matrixMarket = startsWith(first, end, MATRIX_MARKET_BANNER);
+        bool dimacs = p < end && (*p == 'c' || *p == 'p') &&
+                      (p + 1 == end || isBlank(p[1]) || p[1] == '\n');
+        format = matrixMarket ? EdgeListFormat::MatrixMarket
+                 : dimacs     ? EdgeListFormat::Dimacs
+                              : EdgeListFormat::EdgeList;
+    }
+    syntax.format = format;
+    body = begin;
+
+    if (format == EdgeListFormat::MatrixMarket)
+    {
+        const char* eol = lineEnd(first, end);
+        const char* p = first;
+        std::string_view banner = nextToken(p, eol), object = nextToken(p, eol);
+        std::string_view layout = nextToken(p, eol), field = nextToken(p, eol);
+        if (banner != MATRIX_MARKET_BANNER || object != "matrix" || layout != "coordinate")
+        {
+            error = "only coordinate Matrix Market matrices are supported";
+            return false;
+        }
+        if (field != "real" && field != "integer" && field != "double" && field != "pattern")
+        {
+            error = "unsupported Matrix Market field " + std::string(field);
+            return false;
+        }
+        syntax.weighted = field != "pattern";
+        syntax.base = 1;
+
+        p = nextLine(eol, end);
+        for (; p < end; p = nextLine(eol, end))
+        {
+            eol = lineEnd(p, end);
+            const char* q = skipBlanks(p, eol);
+            if (q == eol || *q == '%') continue;
+            int64_t rows = 0, cols = 0, entries = 0;
+            if (!parseToken(q, eol, rows) || !parseToken(q, eol, cols) ||
+                !parseToken(q, eol, entries) || rows < 0 || cols < 0)
+            {
+                error = "bad Matrix Market size line";
+                return false;
+            }
+            syntax.nodeCount = std::max(rows, cols);
+            body = nextLine(eol, end);
+            return true;
+        }
+        error = "missing Matrix Market size line";
+        return false;
+    }
+
+    if (format == EdgeListFormat::Dimacs)
+    {
+        syntax.base = 1;
+        bool sized = false;
+        const char* p = begin;
+        for (const char* eol; p < end; p = nextLine(eol, end))
+        {
+            eol = lineEnd(p, end);
+            const char* q = skipBlanks(p, eol);
+            if (q == eol || *q == 'c') continue;
+            if (*q == 'a' || *q == 'e') break;
+            // p <задача> <вершины> <рёбра>
+            std::string_view tag = nextToken(q, eol);
+            nextToken(q, eol);
+            int64_t nodes = 0, arcs = 0;
+            if (tag != "p" || sized || !parseToken(q, eol, nodes) || !parseToken(q, eol, arcs) ||
+                nodes < 0)
+            {
+                error = "bad DIMACS problem line";
+                return false;
+            }
+            syntax.nodeCount = nodes;
+            sized = true;
+        }
+        if (!sized)
+        {
+            error = "missing DIMACS problem line";
+            return false;
+        }
+        body = p;
+    }
+    return true;
+}
+
+// строки рёбер из [begin, end); ошибка останавливает кусок
+void parseChunk(const char* begin, const char* end, const Syntax& syntax, Chunk& chunk,
+                ImportProgress* progress)
+{
+    int64_t limit = syntax.nodeCount >= 0 ? syntax.nodeCount : INT_MAX;
+    const char* reported = begin;
+    size_t lines = 0;
+    for (const char* p = begin; p < end; lines++)
+    {
+        const char* eol = lineEnd(p, end);
+        const char* q = skipBlanks(p, eol);
+        if (q < eol && !isComment(*q, syntax))
+        {
+            bool tagged = syntax.format != EdgeListFormat::Dimacs || *q == 'a' || *q == 'e';
+            if (syntax.format == EdgeListFormat::Dimacs) q++;
+            int64_t a = 0, b = 0;
+            float weight = NO_WEIGHT;
+            if (!tagged || !parseToken(q, eol, a) || !parseToken(q, eol, b))
+            {
+                chunk.error = "cannot parse edge";
+                chunk.errorAt = p;
+                return;
+            }
+            if (syntax.weighted && skipBlanks(q, eol) < eol)
+            {
+                if (!parseToken(q, eol, weight))
+                {
+                    chunk.error = "cannot parse edge weight";
+                    chunk.errorAt = p;
+                    return;
+                }
+                chunk.hasWeights = true;
+            }
+            a -= syntax.base;
+            b -= syntax.base;
+            if (a < 0 || b < 0 || a >= limit || b >= limit)
+            {
+                chunk.error = "node number out of range";
+                chunk.errorAt = p;
+                return;
+            }
+            chunk.maxId = std::max({chunk.maxId, a, b});
+            auto key = (uint64_t) std::min(a, b) << 32 | (uint64_t) std::max(a, b);
+            chunk.entries.push_back({key, weight});
+        }
+        p = nextLine(eol, end);
+
+        if (progress && lines % PROGRESS_LINES == 0)
+        {
+            progress->parsedBytes.fetch_add((uint64_t) (p - reported), std::memory_order_relaxed);
+            reported = p;
+            if (progress->cancel.load(std::memory_order_relaxed)) return;
+        }
+    }
+    if (progress)
+    {
+        progress->parsedBytes.fetch_add((uint64_t) (end - reported), std::memory_order_relaxed);
+    }
+}
+
+auto byKey(const Entry& a, const Entry& b) -> bool
+{
+    return a.key < b.key;
+}
+
+auto sameKey(const Entry& a, const Entry& b) -> bool
+{
+    return a.key == b.key;
+}
+
+// слияние двух отсортированных кусков в первый; при равных ключах первым
+// идёт ребро левого куска, то есть более раннее в файле
+void mergeInto(std::vector<Entry>& left, std::vector<Entry>& right)
+{
+    std::vector<Entry> merged(left.size() + right.size());
+    std::merge(left.begin(), left.end(), right.begin(), right.end(), merged.begin(), byKey);
+    merged.erase(std::unique(merged.begin(), merged.end(), sameKey), merged.end());
+    left.swap(merged);
+    std::vector<Entry>().swap(right);
+}
+
+// слияние двух отсортированных списков номеров без повторов в первый
+void mergeIds(std::vector<uint32_t>& left, std::vector<uint32_t>& right)
+{
+    std::vector<uint32_t> merged(left.size() + right.size());
+    merged.erase(std::set_union(left.begin(), left.end(), right.begin(), right.end(),
+                                merged.begin()),
+                 merged.end());
+    left.swap(merged);
+    std::vector<uint32_t>().swap(right);
+}
+
+// body(k) для k из [0, count) на threads потоках; задачи разбираются по одной
+template <typename Body>
+void parallelEach(size_t count, unsigned threads, const Body& body)
+{
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        for (size_t k; (k = next.fetch_add(1)) < count;) body(k);
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < std::min<size_t>(threads, count); t++) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+}
+
+auto importFile(const std::string& path, ImportedGraph& out, unsigned threads,
+                ImportProgress* progress, EdgeListFormat format) -> bool
+{
+    out = ImportedGraph();
+    MappedText file;
+    if (!file.open(path))
+    {
+        out.error = "cannot open " + path;
+        return false;
+    }
+    if (progress) progress->totalBytes = (uint64_t) (file.end() - file.begin());
+
+    Syntax syntax;
+    const char* body = nullptr;
+    if (!parseHeader(file.begin(), file.end(), format, syntax, body, out.error)) return false;
+    if (syntax.nodeCount > INT_MAX)
+    {
+        out.error = "too many nodes";
+        return false;
+    }
+    if (progress) progress->parsedBytes = (uint64_t) (body - file.begin());
+
+    // границы кусков сдвигаются к началу следующей строки
+    auto bytes = (size_t) (file.end() - body);
+    size_t count = bytes == 0 ? 0 : std::max<size_t>(threads, (bytes - 1) / CHUNK_BYTES + 1);
+    std::vector<const char*> bounds(count + 1, file.end());
+    bounds[0] = body;
+    for (size_t k = 1; k < count; k++)
+    {
+        const char* p = std::max(body + bytes / count * k, bounds[k - 1]);
+        bounds[k] = p == body ? body : nextLine(lineEnd(p, file.end()), file.end());
+    }
+
+    std::vector<Chunk> chunks(count);
+    parallelEach(count, threads, [&](size_t k) {
+        Chunk& chunk = chunks[k];
+        parseChunk(bounds[k], bounds[k + 1], syntax, chunk, progress);
+        std::stable_sort(chunk.entries.begin(), chunk.entries.end(), byKey);
+        chunk.entries.erase(std::unique(chunk.entries.begin(), chunk.entries.end(), sameKey),
+                            chunk.entries.end());
+    });
+
+    if (progress && progress->cancel)
+    {
+        out.error = "cancelled";
+        return false;
+    }
+    auto failed = std::find_if(chunks.begin(), chunks.end(),
+                               [](const Chunk& chunk) { return chunk.error != nullptr; });
+    if (failed != chunks.end())
+    {
+        auto line = 1 + std::count(file.begin(), failed->errorAt, '\n');
+        out.error = "line " + std::to_string(line) + ": " + failed->error;
+        return false;
+    }
+
+    int64_t maxId = -1;
+    bool hasWeights = false;
+    for (const Chunk& chunk : chunks)
+    {
+        maxId = std::max(maxId, chunk.maxId);
+        hasWeights = hasWeights || chunk.hasWeights;
+    }
+    out.nodeCount = syntax.nodeCount >= 0 ? (size_t) syntax.nodeCount : (size_t) (maxId + 1);
+
+    // попарное слияние кусков: на каждом круге пары сливаются параллельно
+    for (size_t width = 1; width < count; width *= 2)
+    {
+        parallelEach((count + 2 * width - 1) / (2 * width), threads, [&](size_t g) {
+            size_t left = 2 * width * g, right = left + width;
+            if (right < count) mergeInto(chunks[left].entries, chunks[right].entries);
+        });
+    }
+
+    // Число вершин из заголовка берётся как есть: вершины без рёбер в DIMACS и
+    // Matrix Market законны. Редкие номера в списке рёбер без заголовка
+    // сжимаются подряд с сохранением порядка, так что пары остаются
+    // отсортированными.
+    size_t edgeCount = count > 0 ? chunks[0].entries.size() : 0;
+    bool sparse = syntax.nodeCount < 0 &&
+                  out.nodeCount > SPARSE_IDS * 2 * edgeCount + SPARSE_SLACK;
+    if (count == 0) return true;
+    const std::vector<Entry>& entries = chunks[0].entries;
+    std::vector<std::vector<uint32_t>> idParts(sparse ? count : 0);
+    parallelEach(idParts.size(), threads, [&](size_t k) {
+        size_t from = entries.size() * k / count, to = entries.size() * (k + 1) / count;
+        std::vector<uint32_t>& ids = idParts[k];
+        for (size_t e = from; e < to; e++)
+        {
+            ids.push_back((uint32_t) (entries[e].key >> 32));
+            ids.push_back((uint32_t) entries[e].key);
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    });
+    for (size_t width = 1; width < idParts.size(); width *= 2)
+    {
+        parallelEach((idParts.size() + 2 * width - 1) / (2 * width), threads, [&](size_t g) {
+            size_t left = 2 * width * g, right = left + width;
+            if (right < idParts.size()) mergeIds(idParts[left], idParts[right]);
+        });
+    }
+    if (sparse)
+    {
+        out.nodeCount = idParts[0].size();
+        out.originalIds.assign(idParts[0].begin(), idParts[0].end());
+    }
+    auto compact = [&](uint32_t id) {
+        if (!sparse) return (int) id;
+        const std::vector<uint32_t>& ids = idParts[0];
+        return (int) (std::lower_bound(ids.begin(), ids.end(), id) - ids.begin());
+    };
+
+    out.pairs.resize(entries.size());
+    if (hasWeights) out.weights.resize(entries.size());
+    parallelEach(count, threads, [&](size_t k) {
+        size_t from = entries.size() * k / count, to = entries.size() * (k + 1) / count;
+        for (size_t e = from; e < to; e++)
+        {
+            out.pairs[e] = {compact((uint32_t) (entries[e].key >> 32)),
+                            compact((uint32_t) entries[e].key)};
+            if (hasWeights) out.weights[e] = entries[e].weight;
+        }
+    });
+    return true;
+}
+}  // namespace
+
+auto importEdgeList(const std::string& path, ImportedGraph& out, unsigned threads,
+                    ImportProgress* progress, EdgeListFormat format) -> bool
+{
+    bool ok = importFile(path, out, std::max(1U, threads), progress, format);
+    if (progress)
+    {
+        if (ok) progress->parsedBytes = progress->totalBytes.load();
+        progress->finished.store(true, std::memory_order_release);
+    }
+    return ok;
+}
@@ -0,0 +1,165 @@
+#include "ForceKernels.hpp"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GRAPH_X86_KERNELS 1
+#endif
+
+constexpr float MIN_DIST = 0.01F;
+constexpr float OVERLAP_GAP = 2.F;
+
+namespace
+{
+void overlapScalar(float x, float y, float r, const float* xs, const float* ys, const float* rs,
+                   float* pushX, float* pushY, size_t n, float strength)
+{
+    for (size_t k = 0; k < n; k++)
+    {
+        float dx = x - xs[k], dy = y - ys[k];
+        float dist = std::sqrt(dx * dx + dy * dy);
+        float minDist = r + rs[k] + OVERLAP_GAP;
+        bool hit = dist < minDist && dist > MIN_DIST;
+        pushX[k] = hit ? dx / dist * (minDist - dist) * strength : 0.F;
+        pushY[k] = hit ? dy / dist * (minDist - dist) * strength : 0.F;
+    }
+}
+
+void springsScalar(const float* ax, const float* ay, const float* bx, const float* by,
+                   const float* rest, float* forceX, float* forceY, size_t n, float strength)
+{
+    for (size_t k = 0; k < n; k++)
+    {
+        float dx = bx[k] - ax[k], dy = by[k] - ay[k];
+        float dist = std::sqrt(dx * dx + dy * dy);
+        float force = (dist - rest[k]) * strength;
+        bool active = dist > MIN_DIST;
+        forceX[k] = active ? dx / dist * force : 0.F;
+        forceY[k] = active ? dy / dist * force : 0.F;
+    }
+}
+
+#ifdef GRAPH_X86_KERNELS
+__attribute__((target("sse2"))) void overlapSse(float x, float y, float r, const float* xs,
+                                                const float* ys, const float* rs, float* pushX,
+                                                float* pushY, size_t n, float strength)
+{
+    __m128 px = _mm_set1_ps(x), py = _mm_set1_ps(y), pr = _mm_set1_ps(r);
+    __m128 gap = _mm_set1_ps(OVERLAP_GAP), eps = _mm_set1_ps(MIN_DIST);
+    __m128 s = _mm_set1_ps(strength);
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4)
+    {
+        __m128 dx = _mm_sub_ps(px, _mm_loadu_ps(xs + k));
+        __m128 dy = _mm_sub_ps(py, _mm_loadu_ps(ys + k));
+        __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        __m128 minDist = _mm_add_ps(_mm_add_ps(pr, _mm_loadu_ps(rs + k)), gap);
+        __m128 hit = _mm_and_ps(_mm_cmplt_ps(dist, minDist), _mm_cmpgt_ps(dist, eps));
+        __m128 depth = _mm_sub_ps(minDist, dist);
+        __m128 fx = _mm_mul_ps(_mm_mul_ps(_mm_div_ps(dx, dist), depth), s);
+        __m128 fy = _mm_mul_ps(_mm_mul_ps(_mm_div_ps(dy, dist), depth), s);
+        _mm_storeu_ps(pushX + k, _mm_and_ps(fx, hit));
+        _mm_storeu_ps(pushY + k, _mm_and_ps(fy, hit));
+    }
+    overlapScalar(x, y, r, xs + k, ys + k, rs + k, pushX + k, pushY + k, n - k, strength);
+}
+
+__attribute__((target("sse2"))) void springsSse(const float* ax, const float* ay,
+                                                const float* bx, const float* by,
+                                                const float* rest, float* forceX,
+                                                float* forceY, size_t n, float strength)
+{
+    __m128 eps = _mm_set1_ps(MIN_DIST), s = _mm_set1_ps(strength);
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(bx + k), _mm_loadu_ps(ax + k));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(by + k), _mm_loadu_ps(ay + k));
+        __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        __m128 force = _mm_mul_ps(_mm_sub_ps(dist, _mm_loadu_ps(rest + k)), s);
+        __m128 active = _mm_cmpgt_ps(dist, eps);
+        __m128 fx = _mm_mul_ps(_mm_div_ps(dx, dist), force);
+        __m128 fy = _mm_mul_ps(_mm_div_ps(dy, dist), force);
+        _mm_storeu_ps(forceX + k, _mm_and_ps(fx, active));
+        _mm_storeu_ps(forceY + k, _mm_and_ps(fy, active));
+    }
+    springsScalar(ax + k, ay + k, bx + k, by + k, rest + k, forceX + k, forceY + k, n - k,
+                  strength);
+}
+
+__attribute__((target("avx2"))) void overlapAvx2(float x, float y, float r, const float* xs,
+                                                 const float* ys, const float* rs, float* pushX,
+                                                 float* pushY, size_t n, float strength)
+{
+    __m256 px = _mm256_set1_ps(x), py = _mm256_set1_ps(y), pr = _mm256_set1_ps(r);
+    __m256 gap = _mm256_set1_ps(OVERLAP_GAP), eps = _mm256_set1_ps(MIN_DIST);
+    __m256 s = _mm256_set1_ps(strength);
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8)
+    {
+        __m256 dx = _mm256_sub_ps(px, _mm256_loadu_ps(xs + k));
+        __m256 dy = _mm256_sub_ps(py, _mm256_loadu_ps(ys + k));
+        __m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        __m256 minDist = _mm256_add_ps(_mm256_add_ps(pr, _mm256_loadu_ps(rs + k)), gap);
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(dist, minDist, _CMP_LT_OQ),
+                                   _mm256_cmp_ps(dist, eps, _CMP_GT_OQ));
+        __m256 depth = _mm256_sub_ps(minDist, dist);
+        __m256 fx = _mm256_mul_ps(_mm256_mul_ps(_mm256_div_ps(dx, dist), depth), s);
+        __m256 fy = _mm256_mul_ps(_mm256_mul_ps(_mm256_div_ps(dy, dist), depth), s);
+        _mm256_storeu_ps(pushX + k, _mm256_and_ps(fx, hit));
+        _mm256_storeu_ps(pushY + k, _mm256_and_ps(fy, hit));
+    }
+    overlapScalar(x, y, r, xs + k, ys + k, rs + k, pushX + k, pushY + k, n - k, strength);
+}
+
+__attribute__((target("avx2"))) void springsAvx2(const float* ax, const float* ay,
+                                                 const float* bx, const float* by,
+                                                 const float* rest, float* forceX,
+                                                 float* forceY, size_t n, float strength)
+{
+    __m256 eps = _mm256_set1_ps(MIN_DIST), s = _mm256_set1_ps(strength);
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8)
+    {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(bx + k), _mm256_loadu_ps(ax + k));
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(by + k), _mm256_loadu_ps(ay + k));
+        __m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        __m256 force = _mm256_mul_ps(_mm256_sub_ps(dist, _mm256_loadu_ps(rest + k)), s);
+        __m256 active = _mm256_cmp_ps(dist, eps, _CMP_GT_OQ);
+        __m256 fx = _mm256_mul_ps(_mm256_div_ps(dx, dist), force);
+        __m256 fy = _mm256_mul_ps(_mm256_div_ps(dy, dist), force);
+        _mm256_storeu_ps(forceX + k, _mm256_and_ps(fx, active));
+        _mm256_storeu_ps(forceY + k, _mm256_and_ps(fy, active));
+    }
+    springsScalar(ax + k, ay + k, bx + k, by + k, rest + k, forceX + k, forceY + k, n - k,
+                  strength);
+}
+#endif
+
+const ForceKernels SCALAR_KERNELS = {overlapScalar, springsScalar, "scalar"};
+#ifdef GRAPH_X86_KERNELS
+const ForceKernels SSE_KERNELS = {overlapSse, springsSse, "sse2"};
+const ForceKernels AVX2_KERNELS = {overlapAvx2, springsAvx2, "avx2"};
+#endif
+
+auto selectKernels() -> const ForceKernels&
+{
+#ifdef GRAPH_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return AVX2_KERNELS;
+    if (__builtin_cpu_supports("sse2")) return SSE_KERNELS;
+#endif
+    return SCALAR_KERNELS;
+}
+}  // namespace
+
+auto forceKernels() -> const ForceKernels&
+{
+    static const ForceKernels& selected = selectKernels();
+    return selected;
+}
+
+auto scalarForceKernels() -> const ForceKernels&
+{
+    return SCALAR_KERNELS;
+}
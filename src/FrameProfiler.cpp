@@ -0,0 +1,112 @@
+#include "FrameProfiler.hpp"
+#include <algorithm>
+#include <cstdio>
+
+constexpr double NS_PER_MS = 1e6;
+constexpr double NS_PER_US = 1e3;
+// в трейсе физика - отдельная дорожка
+constexpr int MAIN_TRACK = 1;
+constexpr int PHYSICS_TRACK = 2;
+// по порядку Phase
+constexpr const char* PHASE_NAMES[PHASE_COUNT] = {"events", "physics", "updateNodes", "draw",
+                                                  "display"};
+
+namespace
+{
+auto percentile(std::vector<int64_t>& values, double fraction) -> double
+{
+    auto k = (size_t) (fraction * (double) (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + (long) k, values.end());
+    return (double) values[k] / NS_PER_MS;
+}
+}  // namespace
+
+FrameProfiler::FrameProfiler() : origin(now()) {}
+
+auto FrameProfiler::name(Phase phase) -> const char*
+{
+    return PHASE_NAMES[(size_t) phase];
+}
+
+void FrameProfiler::record(Phase phase, int64_t start, int64_t end)
+{
+    Ring& ring = rings[(size_t) phase];
+    uint64_t k = ring.written.load(std::memory_order_relaxed);
+    ring.start[k % SAMPLES].store(start, std::memory_order_relaxed);
+    ring.duration[k % SAMPLES].store(end - start, std::memory_order_relaxed);
+    ring.written.store(k + 1, std::memory_order_release);
+}
+
+void FrameProfiler::snapshot(Phase phase, std::vector<Sample>& out) const
+{
+    const Ring& ring = rings[(size_t) phase];
+    uint64_t written = ring.written.load(std::memory_order_acquire);
+    out.clear();
+    for (uint64_t k = written - std::min<uint64_t>(written, SAMPLES); k < written; k++)
+    {
+        out.push_back({ring.start[k % SAMPLES].load(std::memory_order_relaxed),
+                       ring.duration[k % SAMPLES].load(std::memory_order_relaxed)});
+    }
+}
+
+auto FrameProfiler::stats(Phase phase) const -> Stats
+{
+    std::vector<Sample> samples;
+    snapshot(phase, samples);
+    Stats result;
+    result.count = samples.size();
+    if (samples.empty()) return result;
+
+    std::vector<int64_t> durations;
+    durations.reserve(samples.size());
+    for (const Sample& sample : samples) durations.push_back(sample.duration);
+    result.p50 = percentile(durations, 0.5);
+    result.p95 = percentile(durations, 0.95);
+    result.p99 = percentile(durations, 0.99);
+    result.max = percentile(durations, 1.0);
+    return result;
+}
+
+// Полные события ("ph": "X") с временем в микросекундах от создания
+// профайлера, по возрастанию начала.
+auto FrameProfiler::exportTrace(const std::string& path) const -> bool
+{
+    struct Event
+    {
+        Sample sample;
+        Phase phase;
+    };
+    std::vector<Event> events;
+    std::vector<Sample> samples;
+    for (size_t p = 0; p < PHASE_COUNT; p++)
+    {
+        snapshot((Phase) p, samples);
+        for (const Sample& sample : samples) events.push_back({sample, (Phase) p});
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.sample.start < b.sample.start;
+    });
+
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) return false;
+
+    std::fprintf(file, "{\"traceEvents\": [\n");
+    std::fprintf(file,
+                 "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                 "\"args\": {\"name\": \"main\"}},\n"
+                 "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                 "\"args\": {\"name\": \"physics\"}}",
+                 MAIN_TRACK, PHYSICS_TRACK);
+    for (const Event& event : events)
+    {
+        std::fprintf(file,
+                     ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                     "\"ts\": %.3f, \"dur\": %.3f}",
+                     name(event.phase), event.phase == Phase::Physics ? PHYSICS_TRACK : MAIN_TRACK,
+                     (double) (event.sample.start - origin) / NS_PER_US,
+                     (double) event.sample.duration / NS_PER_US);
+    }
+    std::fprintf(file, "\n]}\n");
+    bool ok = !std::ferror(file);
+    return std::fclose(file) == 0 && ok;
+}
@@ -0,0 +1,103 @@
+#include "GlyphAtlas.hpp"
+#include <algorithm>
+
+// как в sf::Text: четырёхугольник глифа шире его границ на пиксель
+constexpr float GLYPH_PADDING = 1.F;
+
+void GlyphAtlas::load(const sf::Font& font, unsigned size, const std::string& charset)
+{
+    loadedFont = &font;
+    characterSize = size;
+    glyphs = {};
+
+    int slot = 0;
+    for (char ch : charset)
+    {
+        if (slot == (int) MAX_CHARSET) break;
+        auto& glyph = glyphs[(unsigned char) ch & 127];
+        const sf::Glyph& source = font.getGlyph((sf::Uint32) ch, size, false);
+        glyph.advance = source.advance;
+        glyph.bounds = source.bounds;
+        glyph.textureRect = sf::FloatRect(
+            (float) source.textureRect.left, (float) source.textureRect.top,
+            (float) source.textureRect.width, (float) source.textureRect.height);
+        glyph.slot = slot++;
+    }
+
+    for (char a : charset)
+    {
+        for (char b : charset)
+        {
+            int sa = glyphs[(unsigned char) a & 127].slot;
+            int sb = glyphs[(unsigned char) b & 127].slot;
+            if (sa >= 0 && sb >= 0) kernings[sa][sb] = font.getKerning(a, b, size);
+        }
+    }
+}
+
+auto GlyphAtlas::texture() const -> const sf::Texture&
+{
+    return loadedFont->getTexture(characterSize);
+}
+
+auto GlyphAtlas::kerning(char previous, char current) const -> float
+{
+    int sa = glyphs[(unsigned char) previous & 127].slot;
+    int sb = glyphs[(unsigned char) current & 127].slot;
+    return (sa >= 0 && sb >= 0) ? kernings[sa][sb] : 0.F;
+}
+
+auto GlyphAtlas::bounds(const std::string& text) const -> sf::FloatRect
+{
+    float x = 0, y = (float) characterSize;
+    float minX = y, minY = y, maxX = 0, maxY = 0;
+    char previous = 0;
+    for (char ch : text)
+    {
+        const Glyph& glyph = glyphs[(unsigned char) ch & 127];
+        if (glyph.slot < 0) continue;
+        x += kerning(previous, ch);
+        previous = ch;
+
+        minX = std::min(minX, x + glyph.bounds.left);
+        maxX = std::max(maxX, x + glyph.bounds.left + glyph.bounds.width);
+        minY = std::min(minY, y + glyph.bounds.top);
+        maxY = std::max(maxY, y + glyph.bounds.top + glyph.bounds.height);
+        x += glyph.advance;
+    }
+    if (maxX < minX) return {};
+    return {minX, minY, maxX - minX, maxY - minY};
+}
+
+void GlyphAtlas::append(sf::VertexArray& triangles, const std::string& text, sf::Vector2f offset,
+                        sf::Color color) const
+{
+    float x = offset.x, y = offset.y + (float) characterSize;
+    char previous = 0;
+    for (char ch : text)
+    {
+        const Glyph& glyph = glyphs[(unsigned char) ch & 127];
+        if (glyph.slot < 0) continue;
+        x += kerning(previous, ch);
+        previous = ch;
+
+        float left = x + glyph.bounds.left - GLYPH_PADDING;
+        float top = y + glyph.bounds.top - GLYPH_PADDING;
+        float right = x + glyph.bounds.left + glyph.bounds.width + GLYPH_PADDING;
+        float bottom = y + glyph.bounds.top + glyph.bounds.height + GLYPH_PADDING;
+
+        float u1 = glyph.textureRect.left - GLYPH_PADDING;
+        float v1 = glyph.textureRect.top - GLYPH_PADDING;
+        float u2 = glyph.textureRect.left + glyph.textureRect.width + GLYPH_PADDING;
+        float v2 = glyph.textureRect.top + glyph.textureRect.height + GLYPH_PADDING;
+
+        triangles.append(sf::Vertex({left, top}, color, {u1, v1}));
+        triangles.append(sf::Vertex({right, top}, color, {u2, v1}));
+        triangles.append(sf::Vertex({left, bottom}, color, {u1, v2}));
+        triangles.append(sf::Vertex({left, bottom}, color, {u1, v2}));
+        triangles.append(sf::Vertex({right, top}, color, {u2, v1}));
+        triangles.append(sf::Vertex({right, bottom}, color, {u2, v2}));
+
+        x += glyph.advance;
+    }
+}
@@ -1,104 +1,579 @@
 #include "Graph.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
 
-constexpr float REPULSION_STRENGTH = 0.1F;
-constexpr float SPRING_STRENGTH = 0.02F;
+constexpr unsigned EDGE_LABEL_SIZE = 18;
+constexpr unsigned NODE_LABEL_SIZE = 14;
+// столько же точек, сколько у sf::CircleShape по умолчанию
+constexpr size_t CIRCLE_POINTS = 30;
+constexpr float PI = 3.14159265F;
+// вершина считается движущейся столько кадров после последнего сдвига
+constexpr uint32_t RECENT_STEPS = 60;
+constexpr unsigned STATIC_LAYER_ANTIALIASING = 8;
+// фон окна: им залит кэш неподвижной части
+const sf::Color BACKGROUND_COLOR = sf::Color::Black;
+// масштаб в пикселях на единицу мира, ниже которого пропадают подписи,
+// вершины рисуются точками и сливаются в ячейки
+constexpr float LABEL_SCALE = 0.6F;
+constexpr float CIRCLE_SCALE = 0.25F;
+constexpr float AGGREGATE_SCALE = 0.08F;
+constexpr float POINT_PIXELS = 1.F;
+constexpr float AGGREGATE_PIXELS = 6.F;
+const sf::Color AGGREGATE_EDGE_COLOR(255, 255, 255, 60);
 
-void Graph::addNode(const sf::Vector2f& position, const sf::Font& font)
+namespace
 {
-    nodes.emplace_back(position, nodes.size(), font);
+// точки единичной окружности, как у sf::CircleShape: от верхней по часовой
+auto unitCircle() -> const std::array<sf::Vector2f, CIRCLE_POINTS>&
+{
+    static const auto points = [] {
+        std::array<sf::Vector2f, CIRCLE_POINTS> result;
+        for (size_t k = 0; k < CIRCLE_POINTS; k++)
+        {
+            float angle = (float) k * 2 * PI / (float) CIRCLE_POINTS - PI / 2;
+            result[k] = {std::cos(angle), std::sin(angle)};
+        }
+        return result;
+    }();
+    return points;
+}
+}  // namespace
+
+void Graph::addNode(const sf::Vector2f& position)
+{
+    core.addNode(position.x, position.y);
+    nodes.push_back(Node());
+    staticValid = false;
+}
+
+auto Graph::addNodes(const float* xs, const float* ys, size_t count) -> int
+{
+    int first = core.addNodes(xs, ys, count);
+    nodes.resize(nodes.size() + count);
+    staticValid = false;
+    return first;
 }
 
 void Graph::addEdge(int firstNodeId, int secondNodeId)
 {
-    if (hasEdge(firstNodeId, secondNodeId))
+    core.addEdge(firstNodeId, secondNodeId);
+    cullingDirty = true;
+    staticValid = false;
+}
+
+auto Graph::addEdges(const std::pair<int, int>* pairs, size_t count) -> size_t
+{
+    size_t added = core.addEdges(pairs, count);
+    cullingDirty = true;
+    staticValid = false;
+    return added;
+}
+
+// До следующего кадра физики позиции берутся из кадра со старыми номерами:
+// рёбра переехавшей вершины один кадр тянутся к месту удалённой.
+void Graph::removeNode(int id)
+{
+    core.removeNode(id);
+    int last = (int) nodes.size() - 1;
+    if (id != last) nodes[id] = nodes[last];
+    nodes.pop_back();
+    visibleNodes = std::min(visibleNodes, nodes.size());
+    cullingDirty = true;
+    staticValid = false;
+}
+
+// номера рёбер сдвигаются так же, как у вершин, поэтому индекс перестраивается
+void Graph::removeEdge(int edgeId)
+{
+    core.removeEdge(edgeId);
+    cullingDirty = true;
+    staticValid = false;
+}
+
+auto Graph::hasEdge(int firstNodeId, int secondNodeId) const -> bool
+{
+    return core.hasEdge(firstNodeId, secondNodeId);
+}
+
+void Graph::setPosition(int id, sf::Vector2f position)
+{
+    core.moveNode(id, position.x, position.y);
+}
+
+void Graph::updatePhysics(int draggedId)
+{
+    core.step(draggedId);
+}
+
+void Graph::updateNodes()
+{
+    core.growNodes();
+    viewX = &core.posX;
+    viewY = &core.posY;
+    viewRadius = &core.radius;
+    visibleNodes = nodes.size();
+    updateStep++;
+    for (int id : core.changedNodes()) markMoved(id);
+    movedCount = core.changedNodes().size();
+    refreshCulling(core.posX, core.posY, core.changedNodes());
+    core.clearChanged();
+}
+
+void Graph::updateNodes(const PhysicsThread::Frame& frame)
+{
+    viewX = &frame.posX;
+    viewY = &frame.posY;
+    viewRadius = &frame.radius;
+    visibleNodes = std::min(nodes.size(), frame.posX.size());
+    // каждый кадр разбирается один раз; кадры от графа до clear/load могут
+    // упоминать лишние вершины
+    if (frame.step != shownStep)
     {
+        updateStep++;
+        for (int id : frame.dirtyIds) markMoved(id);
+        movedCount = frame.dirtyIds.size();
+        refreshCulling(frame.posX, frame.posY, frame.dirtyIds);
+        shownStep = frame.step;
+    }
+}
+
+void Graph::markMoved(int id)
+{
+    if ((size_t) id >= visibleNodes) return;
+    nodes[id].movedAt = updateStep;
+    // сдвинулась вершина, нарисованная в кэше
+    if (!isMoving(id)) staticValid = false;
+}
+
+void Graph::setDraggedNode(int id)
+{
+    if (id == draggedId) return;
+    draggedId = id;
+    if (id != -1 && !isMoving(id)) staticValid = false;
+}
+
+void Graph::setNodeColor(int id, sf::Color color)
+{
+    if (nodes[id].color == color) return;
+    nodes[id].color = color;
+    staticValid = false;
+}
+
+void Graph::setEdgeSelected(int edgeId, bool selected)
+{
+    if (core.edges[edgeId].IsSelected == selected) return;
+    core.edges[edgeId].IsSelected = selected;
+    staticValid = false;
+}
+
+void Graph::selectEdges(const std::vector<int>& edgeIds)
+{
+    clearSelection();
+    for (int e : edgeIds) setEdgeSelected(e, true);
+}
+
+void Graph::clearSelection()
+{
+    for (auto& edge : core.edges)
+    {
+        if (!edge.IsSelected) continue;
+        edge.IsSelected = false;
+        staticValid = false;
+    }
+}
+
+void Graph::setEdgeWeight(int edgeId, float weight)
+{
+    core.setEdgeWeight(edgeId, weight);
+    staticValid = false;
+}
+
+void Graph::rebuildCulling()
+{
+    culling.build(*viewX, *viewY, visibleNodes, core.edges);
+    culledNodes = visibleNodes;
+    cullingDirty = false;
+}
+
+void Graph::refreshCulling(const std::vector<float>& xs, const std::vector<float>& ys,
+                           const std::vector<int>& moved)
+{
+    if (cullingDirty || culledNodes != visibleNodes)
+    {
+        cullingDirty = true;
         return;
     }
-    edges.emplace_back(firstNodeId, secondNodeId,
-                       distance(nodes[firstNodeId].position, nodes[secondNodeId].position));
+    movedEdgeIds.clear();
+    for (int id : moved)
+    {
+        if ((size_t) id >= visibleNodes) continue;
+        const auto& incident = core.incidentEdgesOf(id);
+        movedEdgeIds.insert(movedEdgeIds.end(), incident.begin(), incident.end());
+    }
+    if (!culling.update(xs, ys, moved, movedEdgeIds)) cullingDirty = true;
 }
 
-auto Graph::hasEdge(int firstNodeId, int secondNodeId) -> bool
+void Graph::draw(sf::RenderTarget& window, const sf::Font& font, int editingEdge,
+                 const std::string& weightInput)
 {
-    for (auto& edge : edges)
+    if (!weightGlyphs.isLoadedFor(font)) weightGlyphs.load(font, EDGE_LABEL_SIZE, "0123456789.-");
+    if (!nodeGlyphs.isLoadedFor(font)) nodeGlyphs.load(font, NODE_LABEL_SIZE, "0123456789");
+    edgeLabels.resize(core.edges.size());
+
+    const sf::View& view = window.getView();
+    sf::Vector2f topLeft = view.getCenter() - view.getSize() / 2.f;
+    sf::Vector2f bottomRight = view.getCenter() + view.getSize() / 2.f;
+    float scale = (float) window.getSize().x / view.getSize().x;
+    bool viewChanged = view.getCenter() != shownCenter || view.getSize() != shownSize;
+    shownCenter = view.getCenter();
+    shownSize = view.getSize();
+
+    // кэш годен: неподвижное - одной картинкой, поверх только движущееся
+    if (staticValid && !viewChanged && window.getSize() == staticLayer.getSize() &&
+        editingEdge == staticEditingEdge && visibleNodes == staticVisibleNodes)
+    {
+        drawStaticLayer(window);
+        drawItems(window, movingEdges, movingIds, scale, editingEdge, weightInput);
+        return;
+    }
+    staticValid = false;
+
+    if (cullingDirty) rebuildCulling();
+    // подпись вершины и вес ребра не выходят за радиус вершины и рамку ребра
+    visibleIds.clear();
+    visibleEdges.clear();
+    culling.query(topLeft.x, topLeft.y, bottomRight.x, bottomRight.y, NODE_RADIUS_MAX, visibleIds,
+                  visibleEdges);
+    // порядок как без отсечения: позже добавленные рисуются поверх
+    std::sort(visibleIds.begin(), visibleIds.end());
+    std::sort(visibleEdges.begin(), visibleEdges.end());
+
+    if (scale < AGGREGATE_SCALE)
+    {
+        drawAggregated(window, topLeft, scale);
+        return;
+    }
+
+    // пока вид меняется или движется почти всё, кэш не окупается
+    if (viewChanged || movedCount * 2 > visibleIds.size() ||
+        !buildStaticLayer(window, scale, editingEdge))
     {
-        if ((edge.firstNodeId == firstNodeId && edge.secondNodeId == secondNodeId) ||
-            (edge.firstNodeId == secondNodeId && edge.secondNodeId == firstNodeId))
+        drawItems(window, visibleEdges, visibleIds, scale, editingEdge, weightInput);
+        return;
+    }
+    drawStaticLayer(window);
+    drawItems(window, movingEdges, movingIds, scale, editingEdge, weightInput);
+}
+
+// Движущиеся - вершины, сдвигавшиеся за последние RECENT_STEPS кадров, и их
+// соседи, у перетаскиваемой - до двух шагов: их скоро сдвинут пружины, и
+// каждый новый сдвиг за пределами набора стоил бы перестройки кэша.
+void Graph::collectMoving()
+{
+    movingMark.assign(visibleNodes, 0);
+    movingIds.clear();
+    auto mark = [&](int id) {
+        if ((size_t) id >= visibleNodes || movingMark[id]) return;
+        movingMark[id] = 1;
+        movingIds.push_back(id);
+    };
+    auto markNeighbors = [&](int id) {
+        for (int e : core.incidentEdgesOf(id))
         {
-            return true;
+            mark(core.edges[e].firstNodeId);
+            mark(core.edges[e].secondNodeId);
         }
+    };
+
+    for (size_t i = 0; i < visibleNodes; i++)
+    {
+        if (updateStep - nodes[i].movedAt <= RECENT_STEPS) mark((int) i);
+    }
+    if (draggedId != -1 && (size_t) draggedId < visibleNodes)
+    {
+        mark(draggedId);
+        markNeighbors(draggedId);
+    }
+    size_t marked = movingIds.size();
+    for (size_t k = 0; k < marked; k++) markNeighbors(movingIds[k]);
+    std::sort(movingIds.begin(), movingIds.end());
+}
+
+// false, если кэш не нужен (движется больше половины видимого) или не создаётся
+auto Graph::buildStaticLayer(sf::RenderTarget& window, float scale, int editingEdge) -> bool
+{
+    collectMoving();
+    if (movingIds.size() * 2 > visibleIds.size()) return false;
+
+    // редактируемое ребро меняет подпись с каждой клавишей - тоже поверх
+    movingEdges.clear();
+    for (int id : movingIds)
+    {
+        const auto& incident = core.incidentEdgesOf(id);
+        movingEdges.insert(movingEdges.end(), incident.begin(), incident.end());
+    }
+    if (editingEdge != -1) movingEdges.push_back(editingEdge);
+    std::sort(movingEdges.begin(), movingEdges.end());
+    movingEdges.erase(std::unique(movingEdges.begin(), movingEdges.end()), movingEdges.end());
+    auto offFrame = [&](int e) {
+        return (size_t) std::max(core.edges[e].firstNodeId, core.edges[e].secondNodeId) >=
+               visibleNodes;
+    };
+    movingEdges.erase(std::remove_if(movingEdges.begin(), movingEdges.end(), offFrame),
+                      movingEdges.end());
+
+    staticIds.clear();
+    staticEdges.clear();
+    for (int i : visibleIds)
+    {
+        if (!movingMark[i]) staticIds.push_back(i);
+    }
+    for (int e : visibleEdges)
+    {
+        const Edge& edge = core.edges[e];
+        if (!movingMark[edge.firstNodeId] && !movingMark[edge.secondNodeId] && e != editingEdge)
+            staticEdges.push_back(e);
     }
 
-    return false;
+    auto size = window.getSize();
+    if (staticLayer.getSize() != size &&
+        !staticLayer.create(size.x, size.y, sf::ContextSettings(0, 0, STATIC_LAYER_ANTIALIASING)))
+    {
+        return false;
+    }
+    staticLayer.setView(window.getView());
+    staticLayer.clear(BACKGROUND_COLOR);
+    drawItems(staticLayer, staticEdges, staticIds, scale, -1, "");
+    staticLayer.display();
+
+    staticValid = true;
+    staticEditingEdge = editingEdge;
+    staticVisibleNodes = visibleNodes;
+    return true;
 }
 
-void Graph::updatePhysics(int draggedId)
+// слой непрозрачный и закрывает всю цель: граф рисуется первым после clear
+void Graph::drawStaticLayer(sf::RenderTarget& window)
 {
-    for (size_t i = 0; i < nodes.size(); i++)
+    sf::View view = window.getView();
+    window.setView(window.getDefaultView());
+    window.draw(sf::Sprite(staticLayer.getTexture()), sf::BlendNone);
+    window.setView(view);
+}
+
+void Graph::drawItems(sf::RenderTarget& target, const std::vector<int>& edgeIds,
+                      const std::vector<int>& nodeIds, float scale, int editingEdge,
+                      const std::string& weightInput)
+{
+    edgeLines.clear();
+    labelTriangles.clear();
+    bool labels = scale >= LABEL_SCALE;
+    for (int i : edgeIds)
     {
-        for (size_t j = i + 1; j < nodes.size(); j++)
+        auto& edge = core.edges[i];
+        auto color = edge.IsSelected ? sf::Color::Red : sf::Color::White;
+        auto first = drawPosition(edge.firstNodeId);
+        auto second = drawPosition(edge.secondNodeId);
+        edgeLines.append(sf::Vertex(first, color));
+        edgeLines.append(sf::Vertex(second, color));
+        if (!labels && i != editingEdge) continue;
+
+        auto& label = edgeLabels[i];
+        int value = (int) edge.weight;
+        if (label.text.empty() || label.value != value)
         {
-            float dist = distance(nodes[i].position, nodes[j].position);
-            float minDist = nodes[i].radius + nodes[j].radius + 2;
-            if (dist < minDist && dist > 0.01F)
-            {
-                auto delta = (nodes[j].position - nodes[i].position) / dist;
-                auto push = delta * (minDist - dist) * REPULSION_STRENGTH;
-                if ((int) i != draggedId) nodes[i].position -= push;
-                if ((int) j != draggedId) nodes[j].position += push;
-            }
+            label.value = value;
+            label.text = std::to_string(value);
+            auto b = weightGlyphs.bounds(label.text);
+            label.origin = sf::Vector2f(b.width / 2, b.height / 2);
         }
-    }
 
-    for (auto& edge : edges)
-    {
-        float dist = distance(nodes[edge.firstNodeId].position, nodes[edge.secondNodeId].position);
-        if (dist > 0.01f)
+        auto mid = (first + second) / 2.f + sf::Vector2f(1, 1);
+        if (i == editingEdge && !weightInput.empty())
+        {
+            auto b = weightGlyphs.bounds(weightInput);
+            weightGlyphs.append(labelTriangles, weightInput,
+                                mid - sf::Vector2f(b.width / 2, b.height / 2), sf::Color::Yellow);
+        }
+        else
         {
-            auto dir =
-                (nodes[edge.secondNodeId].position - nodes[edge.firstNodeId].position) / dist;
-            float force = (dist - edge.weight) * SPRING_STRENGTH;
-            if (edge.firstNodeId != draggedId) nodes[edge.firstNodeId].position += dir * force;
-            if (edge.secondNodeId != draggedId) nodes[edge.secondNodeId].position -= dir * force;
+            weightGlyphs.append(labelTriangles, label.text, mid - label.origin,
+                                i == editingEdge ? sf::Color::Yellow : sf::Color::Green);
         }
     }
+
+    target.draw(edgeLines);
+    target.draw(labelTriangles, sf::RenderStates(&weightGlyphs.texture()));
+    if (scale >= CIRCLE_SCALE)
+    {
+        drawCircles(target, nodeIds, labels);
+        return;
+    }
+
+    // точки: квадрат не меньше пикселя, цвет как у круга вершины
+    nodeQuads.clear();
+    for (int i : nodeIds)
+    {
+        auto center = drawPosition(i);
+        float half = std::max((*viewRadius)[i], POINT_PIXELS / scale);
+        auto color = nodes[i].color;
+        nodeQuads.append(sf::Vertex(center + sf::Vector2f(-half, -half), color));
+        nodeQuads.append(sf::Vertex(center + sf::Vector2f(half, -half), color));
+        nodeQuads.append(sf::Vertex(center + sf::Vector2f(half, half), color));
+        nodeQuads.append(sf::Vertex(center + sf::Vector2f(-half, half), color));
+    }
+    target.draw(nodeQuads);
 }
 
-void Graph::updateNodes()
+// Круги - веерами треугольников по unitCircle, подписи - глифами из
+// nodeGlyphs; подписи рисуются поверх всех кругов.
+void Graph::drawCircles(sf::RenderTarget& target, const std::vector<int>& nodeIds, bool labels)
 {
-    for (auto& n : nodes) n.update();
+    const auto& circle = unitCircle();
+    circleTriangles.clear();
+    nodeLabelTriangles.clear();
+    for (int i : nodeIds)
+    {
+        auto center = drawPosition(i);
+        float r = (*viewRadius)[i];
+        auto color = nodes[i].color;
+        for (size_t k = 0; r > 0 && k < CIRCLE_POINTS; k++)
+        {
+            circleTriangles.append(sf::Vertex(center, color));
+            circleTriangles.append(sf::Vertex(center + circle[k] * r, color));
+            circleTriangles.append(sf::Vertex(center + circle[(k + 1) % CIRCLE_POINTS] * r, color));
+        }
+        if (!labels) continue;
+
+        nodeLabel = std::to_string(i);
+        auto b = nodeGlyphs.bounds(nodeLabel);
+        nodeGlyphs.append(nodeLabelTriangles, nodeLabel,
+                          center - sf::Vector2f(b.width / 2, b.height / 2), sf::Color::White);
+    }
+    target.draw(circleTriangles);
+    target.draw(nodeLabelTriangles, sf::RenderStates(&nodeGlyphs.texture()));
 }
 
-void Graph::draw(sf::RenderWindow& window, const sf::Font& font, int editingEdge,
-                 const std::string& weightInput)
+// Вершины раскладываются по ячейкам в AGGREGATE_PIXELS экрана, и каждая
+// ячейка рисуется одним квадратом, тем ярче, чем больше в ней вершин. Из рёбер
+// остаются по одной линии на пару разных ячеек; выделенные рисуются поверх.
+void Graph::drawAggregated(sf::RenderTarget& window, sf::Vector2f topLeft, float scale)
 {
-    for (int i = 0; i < (int) edges.size(); i++)
+    float bin = AGGREGATE_PIXELS / scale;
+    // +1: вершины из полосы margin левее и выше вида
+    auto binOf = [&](int id) {
+        auto column = (uint64_t) std::max(0.F, std::floor(((*viewX)[id] - topLeft.x) / bin) + 1);
+        auto row = (uint64_t) std::max(0.F, std::floor(((*viewY)[id] - topLeft.y) / bin) + 1);
+        return std::min<uint64_t>(row, UINT16_MAX) << 16 | std::min<uint64_t>(column, UINT16_MAX);
+    };
+    auto binCenter = [&](uint64_t key) {
+        return topLeft + sf::Vector2f(((float) (key & UINT16_MAX) - 0.5F) * bin,
+                                      ((float) (key >> 16) - 0.5F) * bin);
+    };
+
+    edgeLines.clear();
+    binKeys.clear();
+    for (int e : visibleEdges)
     {
-        auto& edge = edges[i];
-        auto color = edge.IsSelected ? sf::Color::Red : sf::Color::White;
+        auto& edge = core.edges[e];
+        if (edge.IsSelected) continue;
+        uint64_t a = binOf(edge.firstNodeId), b = binOf(edge.secondNodeId);
+        if (a != b) binKeys.push_back(std::min(a, b) << 32 | std::max(a, b));
+    }
+    std::sort(binKeys.begin(), binKeys.end());
+    binKeys.erase(std::unique(binKeys.begin(), binKeys.end()), binKeys.end());
 
-        sf::Vertex line[] = {sf::Vertex(nodes[edge.firstNodeId].position, color),
-                             sf::Vertex(nodes[edge.secondNodeId].position, color)};
-        window.draw(line, 2, sf::Lines);
+    for (uint64_t pair : binKeys)
+    {
+        edgeLines.append(sf::Vertex(binCenter(pair >> 32), AGGREGATE_EDGE_COLOR));
+        edgeLines.append(sf::Vertex(binCenter(pair & UINT32_MAX), AGGREGATE_EDGE_COLOR));
+    }
+    for (int e : visibleEdges)
+    {
+        auto& edge = core.edges[e];
+        if (!edge.IsSelected) continue;
+        edgeLines.append(sf::Vertex(drawPosition(edge.firstNodeId), sf::Color::Red));
+        edgeLines.append(sf::Vertex(drawPosition(edge.secondNodeId), sf::Color::Red));
+    }
+
+    binKeys.clear();
+    for (int i : visibleIds) binKeys.push_back(binOf(i));
+    std::sort(binKeys.begin(), binKeys.end());
 
-        auto mid = (nodes[edge.firstNodeId].position + nodes[edge.secondNodeId].position) / 2.f;
-        sf::Text text;
-        text.setFont(font);
-        text.setString((i == editingEdge && !weightInput.empty())
-                           ? weightInput
-                           : std::to_string((int) edge.weight));
-        text.setFillColor(i == editingEdge ? sf::Color::Yellow : sf::Color::Green);
-        text.setCharacterSize(18);
-        auto b = text.getLocalBounds();
-        text.setOrigin(b.width / 2, b.height / 2);
-        text.setPosition(mid + sf::Vector2f(1, 1));
-        window.draw(text);
+    nodeQuads.clear();
+    float half = bin * 0.4F;
+    for (size_t k = 0; k < binKeys.size();)
+    {
+        size_t next = k;
+        while (next < binKeys.size() && binKeys[next] == binKeys[k]) next++;
+        // яркость растёт с логарифмом числа вершин и доходит до белого
+        float t = std::min(1.F, std::log2((float) (next - k)) / 8);
+        sf::Color color((sf::Uint8) (NODE_COLOR.r + (255 - NODE_COLOR.r) * t),
+                        (sf::Uint8) (NODE_COLOR.g + (255 - NODE_COLOR.g) * t),
+                        (sf::Uint8) (NODE_COLOR.b + (255 - NODE_COLOR.b) * t));
+        auto center = binCenter(binKeys[k]);
+        nodeQuads.append(sf::Vertex(center + sf::Vector2f(-half, -half), color));
+        nodeQuads.append(sf::Vertex(center + sf::Vector2f(half, -half), color));
+        nodeQuads.append(sf::Vertex(center + sf::Vector2f(half, half), color));
+        nodeQuads.append(sf::Vertex(center + sf::Vector2f(-half, half), color));
+        k = next;
     }
-    for (auto& n : nodes) n.draw(window);
+
+    window.draw(edgeLines);
+    window.draw(nodeQuads);
 }
 
 void Graph::clear()
+{
+    core.clear();
+    nodes.clear();
+    visibleNodes = 0;
+    edgeLabels.clear();
+    cullingDirty = true;
+    staticValid = false;
+}
+
+auto Graph::load(const std::string& path) -> bool
+{
+    if (!core.load(path)) return false;
+    resetNodes();
+    return true;
+}
+
+void Graph::importGraph(const ImportedGraph& imported)
+{
+    core.importGraph(imported);
+    resetNodes();
+}
+
+void Graph::resetNodes()
 {
     nodes.clear();
-    edges.clear();
+    nodes.resize(core.nodeCount());
+    edgeLabels.clear();
+    visibleNodes = 0;
+    cullingDirty = true;
+    staticValid = false;
+}
+
+// массивы вершин считаются по заполненной части (ёмкость sf::VertexArray не
+// видна), кэш неподвижной части - по 4 байта на пиксель
+auto Graph::memoryStats() const -> MemoryStats
+{
+    MemoryStats stats = core.memoryStats();
+    stats.nodeBytes += nodes.memoryBytes();
+    stats.edgeBytes += vectorBytes(edgeLabels);
+    stats.indexBytes += culling.memoryBytes();
+    size_t vertices = edgeLines.getVertexCount() + labelTriangles.getVertexCount() +
+                      nodeQuads.getVertexCount() + circleTriangles.getVertexCount() +
+                      nodeLabelTriangles.getVertexCount();
+    auto layer = staticLayer.getSize();
+    stats.scratchBytes += vectorBytes(visibleIds) + vectorBytes(visibleEdges) +
+                          vectorBytes(binKeys) + vertices * sizeof(sf::Vertex) +
+                          vectorBytes(movingMark) + vectorBytes(movingIds) +
+                          vectorBytes(movingEdges) + vectorBytes(staticIds) +
+                          vectorBytes(staticEdges) + vectorBytes(movedEdgeIds) +
+                          (size_t) layer.x * layer.y * 4;
+    return stats;
 }
@@ -0,0 +1,1104 @@
+#include "GraphCore.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+constexpr float REPULSION_STRENGTH = 0.1F;
+constexpr float MAX_REPULSION_STEP = 5.F;
+constexpr size_t SAVE_CHUNK_EDGES = 1 << 16;
+constexpr size_t BULK_REINDEX_RATIO = 4;
+// на вершину при импорте приходится квадрат с такой стороной
+constexpr float IMPORT_SPACING = 4 * NODE_RADIUS_MAX;
+constexpr unsigned IMPORT_SEED = 1;
+
+// вершина засыпает, если SLEEP_STEPS шагов подряд сдвигалась меньше SLEEP_DISTANCE
+constexpr float SLEEP_DISTANCE = 0.05F;
+constexpr uint16_t SLEEP_STEPS = 45;
+
+// запас ячейки: пока каждая вершина за проход сдвинулась не больше чем на
+// skin / 2, все пересекающиеся пары гарантированно лежат в соседних ячейках;
+// если запаса не хватило, проход повторяется с вдвое большим
+constexpr float GRID_SKIN = NODE_RADIUS_MAX;
+constexpr float MAX_GRID_SKIN = 64 * NODE_RADIUS_MAX;
+constexpr float GRID_CELL_SIZE = 2 * NODE_RADIUS_MAX + 2 + GRID_SKIN;
+
+namespace
+{
+auto distance(float ax, float ay, float bx, float by) -> float
+{
+    auto dx = ax - bx, dy = ay - by;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+auto nearSegment(float px, float py, float ax, float ay, float bx, float by, float tolerance)
+    -> bool
+{
+    float abX = bx - ax, abY = by - ay;
+    float abLen2 = abX * abX + abY * abY;
+    if (abLen2 < 1e-6F) return false;
+    float proj = ((px - ax) * abX + (py - ay) * abY) / abLen2;
+    proj = std::max(0.F, std::min(1.F, proj));
+    return distance(px, py, ax + proj * abX, ay + proj * abY) < tolerance;
+}
+
+// сила каждой из n пружин на её первый конец по закону модели
+template <typename Model>
+void springForces(const float* ax, const float* ay, const float* bx, const float* by,
+                  const float* rest, float* forceX, float* forceY, size_t n)
+{
+    for (size_t k = 0; k < n; k++)
+    {
+        float dx = bx[k] - ax[k], dy = by[k] - ay[k];
+        float dist = std::sqrt(dx * dx + dy * dy);
+        float force = Model::spring(dist, rest[k]);
+        bool active = dist > 0.01F;
+        forceX[k] = active ? dx / dist * force : 0.F;
+        forceY[k] = active ? dy / dist * force : 0.F;
+    }
+}
+
+void eraseValue(std::vector<int>& list, int value)
+{
+    auto it = std::find(list.begin(), list.end(), value);
+    if (it == list.end()) return;
+    *it = list.back();
+    list.pop_back();
+}
+
+void replaceValue(std::vector<int>& list, int from, int to)
+{
+    *std::find(list.begin(), list.end(), from) = to;
+}
+
+// место под extra новых элементов; частые мелкие пачки растят ёмкость
+// вдвое, как push_back, а не ровно на пачку
+template <typename T>
+void reserveMore(std::vector<T>& values, size_t extra)
+{
+    size_t need = values.size() + extra;
+    if (need > values.capacity()) values.reserve(std::max(need, 2 * values.capacity()));
+}
+}  // namespace
+
+auto GraphCore::addNode(float x, float y) -> int
+{
+    posX.push_back(x);
+    posY.push_back(y);
+    radius.push_back(0.F);
+    growing.push_back(1);
+    growingIds.push_back((int) posX.size() - 1);
+    asleep.push_back(0);
+    quietSteps.push_back(0);
+    changedSlot.push_back(-1);
+    incidentEdges.emplace_back();
+    nodeHandles.add();
+    components.add();
+    pathsDirty = true;
+    int id = (int) posX.size() - 1;
+    markChanged(id);
+    if (!pickIndexDirty) pickIndex.addNode(id, x, y);
+    return id;
+}
+
+void GraphCore::addEdge(int firstNodeId, int secondNodeId)
+{
+    if (!edgeIndex.insert(firstNodeId, secondNodeId))
+    {
+        return;
+    }
+    edges.emplace_back(firstNodeId, secondNodeId,
+                       distance(posX[firstNodeId], posY[firstNodeId], posX[secondNodeId],
+                                posY[secondNodeId]));
+    int id = (int) edges.size() - 1;
+    if (!pickIndexDirty) pickIndex.addEdge(id, firstNodeId, secondNodeId);
+    incidentEdges[firstNodeId].push_back(id);
+    if (secondNodeId != firstNodeId) incidentEdges[secondNodeId].push_back(id);
+    edgeHandles.add();
+    pathsDirty = true;
+    if (!componentsDirty) components.unite(firstNodeId, secondNodeId);
+    wakeNode(firstNodeId);
+    wakeNode(secondNodeId);
+}
+
+auto GraphCore::addNodes(const float* xs, const float* ys, size_t count) -> int
+{
+    auto first = (int) posX.size();
+    reserveMore(posX, count);
+    reserveMore(posY, count);
+    reserveMore(changedIds, count);
+    nodeHandles.reserve(posX.capacity());
+
+    posX.insert(posX.end(), xs, xs + count);
+    posY.insert(posY.end(), ys, ys + count);
+    size_t n = posX.size();
+    radius.resize(n, 0.F);
+    growing.resize(n, 1);
+    for (size_t i = n - count; i < n; i++) growingIds.push_back((int) i);
+    asleep.resize(n, 0);
+    quietSteps.resize(n, 0);
+    changedSlot.resize(n, -1);
+    incidentEdges.resize(n);
+    if (!pickIndexDirty && count * BULK_REINDEX_RATIO >= n) invalidatePickIndex();
+    for (auto id = first; id < (int) n; id++)
+    {
+        nodeHandles.add();
+        components.add();
+        markChanged(id);
+        if (!pickIndexDirty) pickIndex.addNode(id, posX[id], posY[id]);
+    }
+    if (count > 0) pathsDirty = true;
+    return first;
+}
+
+auto GraphCore::addEdges(const std::pair<int, int>* pairs, size_t count) -> size_t
+{
+    auto n = (int) posX.size();
+    std::vector<uint64_t> keys;
+    keys.reserve(count);
+    for (size_t k = 0; k < count; k++)
+    {
+        auto [a, b] = pairs[k];
+        if (a < 0 || b < 0 || a >= n || b >= n) continue;
+        keys.push_back((uint64_t) std::min(a, b) << 32 | (uint32_t) std::max(a, b));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    // сначала отсеиваем существующие, чтобы знать, сколько места нужно
+    edgeIndex.reserve(edgeIndex.size() + keys.size());
+    size_t added = 0;
+    for (uint64_t key : keys)
+    {
+        if (edgeIndex.insert((int) (key >> 32), (int) (uint32_t) key)) keys[added++] = key;
+    }
+    keys.resize(added);
+
+    reserveMore(edges, added);
+    edgeHandles.reserve(edges.capacity());
+    // степени считаются только по концам пачки: малая пачка не обходит весь граф
+    std::vector<int> ends;
+    ends.reserve(2 * added);
+    for (uint64_t key : keys)
+    {
+        ends.push_back((int) (key >> 32));
+        if ((key >> 32) != (uint32_t) key) ends.push_back((int) (uint32_t) key);
+    }
+    std::sort(ends.begin(), ends.end());
+    for (size_t k = 0, run; k < ends.size(); k += run)
+    {
+        run = (size_t) (std::upper_bound(ends.begin() + (ptrdiff_t) k, ends.end(), ends[k]) -
+                        ends.begin()) - k;
+        reserveMore(incidentEdges[ends[k]], run);
+    }
+
+    if (!pickIndexDirty && added * BULK_REINDEX_RATIO >= edges.size() + added)
+        invalidatePickIndex();
+    for (uint64_t key : keys)
+    {
+        auto a = (int) (key >> 32), b = (int) (uint32_t) key;
+        edges.emplace_back(a, b, distance(posX[a], posY[a], posX[b], posY[b]));
+        int id = (int) edges.size() - 1;
+        if (!pickIndexDirty) pickIndex.addEdge(id, a, b);
+        incidentEdges[a].push_back(id);
+        if (b != a) incidentEdges[b].push_back(id);
+        edgeHandles.add();
+        if (!componentsDirty) components.unite(a, b);
+        wakeNode(a);
+        wakeNode(b);
+    }
+    if (added > 0) pathsDirty = true;
+    return added;
+}
+
+void GraphCore::setEdgeWeight(int edgeId, float weight)
+{
+    edges[edgeId].weight = weight;
+    pathsDirty = true;
+    wakeNode(edges[edgeId].firstNodeId);
+    wakeNode(edges[edgeId].secondNodeId);
+}
+
+auto GraphCore::hasEdge(int firstNodeId, int secondNodeId) const -> bool
+{
+    return edgeIndex.contains(firstNodeId, secondNodeId);
+}
+
+void GraphCore::moveNode(int id, float x, float y)
+{
+    posX[id] = x;
+    posY[id] = y;
+    positionsVersion++;
+    if (!pickIndexDirty) pickIndex.moveNode(id, x, y);
+    wakeNode(id);
+    markChanged(id);
+}
+
+// Последнее ребро переезжает на место удалённого: в списках смежности его
+// концов меняется один номер.
+void GraphCore::removeEdge(int edgeId)
+{
+    int first = edges[edgeId].firstNodeId, second = edges[edgeId].secondNodeId;
+    edgeIndex.erase(first, second);
+    eraseValue(incidentEdges[first], edgeId);
+    eraseValue(incidentEdges[second], edgeId);
+    if (!pickIndexDirty) pickIndex.eraseEdge(edgeId);
+    wakeNode(first);
+    wakeNode(second);
+
+    int last = (int) edges.size() - 1;
+    if (edgeId != last)
+    {
+        edges[edgeId] = edges[last];
+        first = edges[edgeId].firstNodeId;
+        second = edges[edgeId].secondNodeId;
+        replaceValue(incidentEdges[first], last, edgeId);
+        if (second != first) replaceValue(incidentEdges[second], last, edgeId);
+        if (!pickIndexDirty) pickIndex.renameEdge(last, edgeId);
+    }
+    edges.pop_back();
+    edgeHandles.remove(edgeId);
+    pathsDirty = true;
+    componentsDirty = true;
+}
+
+// Последняя вершина переезжает на место удалённой: меняются только её рёбра.
+void GraphCore::removeNode(int id)
+{
+    while (!incidentEdges[id].empty()) removeEdge(incidentEdges[id].back());
+    if (!pickIndexDirty) pickIndex.eraseNode(id);
+    if (asleep[id]) sleepingCount--;
+    unlistChanged(id);
+
+    int last = (int) posX.size() - 1;
+    if (growing[id])
+    {
+        *std::find(growingIds.begin(), growingIds.end(), id) = growingIds.back();
+        growingIds.pop_back();
+    }
+    if (id != last && growing[last]) *std::find(growingIds.begin(), growingIds.end(), last) = id;
+    if (id != last)
+    {
+        posX[id] = posX[last];
+        posY[id] = posY[last];
+        radius[id] = radius[last];
+        growing[id] = growing[last];
+        asleep[id] = asleep[last];
+        quietSteps[id] = quietSteps[last];
+        incidentEdges[id] = std::move(incidentEdges[last]);
+        for (int e : incidentEdges[id])
+        {
+            Edge& edge = edges[e];
+            edgeIndex.erase(edge.firstNodeId, edge.secondNodeId);
+            if (edge.firstNodeId == last) edge.firstNodeId = id;
+            if (edge.secondNodeId == last) edge.secondNodeId = id;
+            edgeIndex.insert(edge.firstNodeId, edge.secondNodeId);
+        }
+        if (!pickIndexDirty) pickIndex.renameNode(last, id);
+        unlistChanged(last);
+        markChanged(id);
+    }
+    posX.pop_back();
+    posY.pop_back();
+    radius.pop_back();
+    growing.pop_back();
+    asleep.pop_back();
+    quietSteps.pop_back();
+    incidentEdges.pop_back();
+    changedSlot.pop_back();
+    nodeHandles.remove(id);
+    pathsDirty = true;
+    componentsDirty = true;
+}
+
+auto GraphCore::shortestPath(int from, int to, std::vector<int>& path, bool useAStar) -> float
+{
+    if (pathsDirty)
+    {
+        paths.build(edges, posX.size());
+        pathsDirty = false;
+    }
+    return useAStar ? paths.aStar(from, to, posX, posY, positionsVersion, path)
+                    : paths.dijkstra(from, to, path);
+}
+
+void GraphCore::refreshComponents()
+{
+    if (!componentsDirty) return;
+    components.reset(posX.size());
+    for (const Edge& edge : edges) components.unite(edge.firstNodeId, edge.secondNodeId);
+    componentsDirty = false;
+}
+
+auto GraphCore::componentOf(int id) -> int
+{
+    refreshComponents();
+    return components.find(id);
+}
+
+auto GraphCore::connected(int firstNodeId, int secondNodeId) -> bool
+{
+    return componentOf(firstNodeId) == componentOf(secondNodeId);
+}
+
+auto GraphCore::componentCount() -> size_t
+{
+    refreshComponents();
+    return components.setCount();
+}
+
+auto GraphCore::minimumSpanningForest(std::vector<int>& forest) -> float
+{
+    return spanningForest.build(edges, incidentEdges, threadPool(), forest);
+}
+
+void GraphCore::layoutMultilevel()
+{
+    (multilevel.*forceModel->layout)(edges, posX, posY, threadPool());
+    markAllMoved();
+}
+
+void GraphCore::snapshotLayout(LayoutJob& job) const
+{
+    job.edges = edges;
+    job.x = posX;
+    job.y = posY;
+    job.model = forceModel;
+}
+
+auto GraphCore::applyLayout(const LayoutJob& job) -> bool
+{
+    if (job.x.size() != posX.size()) return false;
+    posX = job.x;
+    posY = job.y;
+    markAllMoved();
+    return true;
+}
+
+void GraphCore::markAllMoved()
+{
+    positionsVersion++;
+    invalidatePickIndex();
+    wakeAll();
+    for (size_t i = 0; i < posX.size(); i++) markChanged((int) i);
+}
+
+auto GraphCore::threadPool() -> ThreadPool&
+{
+    if (!pool || pool->size() != threadCount) pool = std::make_unique<ThreadPool>(threadCount);
+    return *pool;
+}
+
+auto GraphCore::pickNode(float x, float y) const -> int
+{
+    if (pickIndexDirty)
+    {
+        for (int i = 0; i < (int) posX.size(); i++)
+        {
+            if (distance(x, y, posX[i], posY[i]) <= radius[i]) return i;
+        }
+        return -1;
+    }
+
+    std::vector<int> candidates;
+    pickIndex.queryNodes(x, y, candidates);
+
+    int picked = -1;
+    for (int i : candidates)
+    {
+        if ((picked == -1 || i < picked) && distance(x, y, posX[i], posY[i]) <= radius[i])
+        {
+            picked = i;
+        }
+    }
+    return picked;
+}
+
+auto GraphCore::pickEdge(float x, float y, float tolerance) const -> int
+{
+    auto isNear = [&](int e) {
+        int a = edges[e].firstNodeId, b = edges[e].secondNodeId;
+        return nearSegment(x, y, posX[a], posY[a], posX[b], posY[b], tolerance);
+    };
+
+    std::vector<int> candidates;
+    if (tolerance > PickIndex::CELL_SIZE || pickIndexDirty ||
+        !pickIndex.queryEdges(x, y, candidates, edges.size()))
+    {
+        for (int e = 0; e < (int) edges.size(); e++)
+        {
+            if (isNear(e)) return e;
+        }
+        return -1;
+    }
+
+    int picked = -1;
+    for (int e : candidates)
+    {
+        if ((picked == -1 || e < picked) && isNear(e)) picked = e;
+    }
+    return picked;
+}
+
+void GraphCore::step(int draggedId)
+{
+    if (draggedId != -1) wakeNode(draggedId);
+    if (sleepingCount == posX.size())
+    {
+        stepEnergy = 0.F;
+        return;
+    }
+    stepStartX = posX;
+    stepStartY = posY;
+    positionsVersion++;
+
+    (this->*forceModel->step)(draggedId);
+
+    refreshPickIndex();
+    updateSleep(draggedId);
+}
+
+template <typename Model>
+void GraphCore::stepWith(int draggedId)
+{
+    if (parallelStep)
+    {
+        stepParallel<Model>(draggedId);
+        return;
+    }
+
+    if (longRange<Model>())
+    {
+        applyLongRangeRepulsion<Model>(draggedId);
+    }
+
+    bool resolved = false;
+    for (float skin = GRID_SKIN; !bruteForceOverlap && !resolved && skin <= MAX_GRID_SKIN;
+         skin *= 2)
+    {
+        resolved = resolveOverlapsGrid(draggedId, skin);
+    }
+    if (!resolved)
+    {
+        resolveOverlapsBruteForce(draggedId);
+    }
+
+    applySprings<Model>(draggedId);
+}
+
+auto GraphCore::forceModels() -> const std::vector<ForceModelKernel>&
+{
+    static const std::vector<ForceModelKernel> models = {
+        {LinearSpring::NAME, &GraphCore::stepWith<LinearSpring>,
+         &MultilevelLayout::run<LinearSpring>},
+        {LogSpring::NAME, &GraphCore::stepWith<LogSpring>, &MultilevelLayout::run<LogSpring>},
+        {FruchtermanReingold::NAME, &GraphCore::stepWith<FruchtermanReingold>,
+         &MultilevelLayout::run<FruchtermanReingold>},
+        {ForceAtlas2::NAME, &GraphCore::stepWith<ForceAtlas2>,
+         &MultilevelLayout::run<ForceAtlas2>},
+    };
+    return models;
+}
+
+auto GraphCore::setForceModel(const std::string& name) -> bool
+{
+    const std::vector<ForceModelKernel>& models = forceModels();
+    auto found = std::find_if(models.begin(), models.end(),
+                              [&](const ForceModelKernel& model) { return name == model.name; });
+    if (found == models.end()) return false;
+    forceModel = &*found;
+    wakeAll();
+    return true;
+}
+
+void GraphCore::wakeNode(int id)
+{
+    if (asleep[id])
+    {
+        asleep[id] = 0;
+        sleepingCount--;
+    }
+    quietSteps[id] = 0;
+}
+
+void GraphCore::markChanged(int id)
+{
+    if (changedSlot[id] != -1) return;
+    changedSlot[id] = (int32_t) changedIds.size();
+    changedIds.push_back(id);
+}
+
+void GraphCore::unlistChanged(int id)
+{
+    int32_t slot = changedSlot[id];
+    if (slot == -1) return;
+    changedIds[slot] = changedIds.back();
+    changedSlot[changedIds[slot]] = slot;
+    changedIds.pop_back();
+    changedSlot[id] = -1;
+}
+
+void GraphCore::clearChanged()
+{
+    for (int id : changedIds) changedSlot[id] = -1;
+    changedIds.clear();
+}
+
+void GraphCore::wakeAll()
+{
+    std::fill(asleep.begin(), asleep.end(), 0);
+    std::fill(quietSteps.begin(), quietSteps.end(), 0);
+    sleepingCount = 0;
+}
+
+// Заметно сдвинувшаяся (или перетаскиваемая, или растущая) вершина будит
+// соседей по рёбрам и вершины, с которыми пересекается; остальные копят
+// спокойные шаги и засыпают. Будят после шага, а не внутри проходов, чтобы
+// параллельный шаг оставался детерминированным.
+void GraphCore::updateSleep(int draggedId)
+{
+    stepEnergy = 0.F;
+    movingIds.clear();
+    for (size_t i = 0; i < posX.size(); i++)
+    {
+        if (asleep[i]) continue;
+        float dx = posX[i] - stepStartX[i], dy = posY[i] - stepStartY[i];
+        float moved2 = dx * dx + dy * dy;
+        stepEnergy += moved2;
+        if (moved2 > 0) markChanged((int) i);
+        if (moved2 > SLEEP_DISTANCE * SLEEP_DISTANCE || (int) i == draggedId || growing[i])
+        {
+            quietSteps[i] = 0;
+            movingIds.push_back((int) i);
+        }
+        else if (sleeping && ++quietSteps[i] >= SLEEP_STEPS)
+        {
+            asleep[i] = 1;
+            sleepingCount++;
+        }
+    }
+    if (sleepingCount == 0) return;
+
+    for (int i : movingIds)
+    {
+        for (int e : incidentEdges[i])
+        {
+            const Edge& edge = edges[e];
+            wakeNode(edge.firstNodeId == i ? edge.secondNodeId : edge.firstNodeId);
+        }
+        candidates.clear();
+        pickIndex.queryNodes(posX[i], posY[i], candidates);
+        for (int j : candidates)
+        {
+            float reach = radius[i] + radius[j] + 2;
+            if (asleep[j] && distance(posX[i], posY[i], posX[j], posY[j]) < reach) wakeNode(j);
+        }
+    }
+}
+
+// Вершина переносится между ячейками только при пересечении их границы.
+void GraphCore::refreshPickIndex()
+{
+    if (pickIndexDirty)
+    {
+        pickIndexDirty = false;
+        for (size_t i = 0; i < posX.size(); i++) pickIndex.addNode((int) i, posX[i], posY[i]);
+        for (size_t e = 0; e < edges.size(); e++)
+        {
+            pickIndex.addEdge((int) e, edges[e].firstNodeId, edges[e].secondNodeId);
+        }
+        return;
+    }
+    for (size_t i = 0; i < posX.size(); i++)
+    {
+        if (!asleep[i]) pickIndex.moveNode((int) i, posX[i], posY[i]);
+    }
+}
+
+void GraphCore::invalidatePickIndex()
+{
+    pickIndex.clear();
+    pickIndexDirty = true;
+}
+
+void GraphCore::growNodes()
+{
+    size_t kept = 0;
+    for (int id : growingIds)
+    {
+        if (radius[id] < NODE_RADIUS_MAX)
+        {
+            radius[id] += NODE_GROWTH_SPEED;
+            markChanged(id);
+            growingIds[kept++] = id;
+        }
+        else
+        {
+            growing[id] = 0;
+        }
+    }
+    growingIds.resize(kept);
+}
+
+auto GraphCore::pushApart(size_t i, size_t j, int draggedId) -> float
+{
+    float dist = distance(posX[i], posY[i], posX[j], posY[j]);
+    float minDist = radius[i] + radius[j] + 2;
+    if (dist < minDist && dist > 0.01F)
+    {
+        float pushX = (posX[j] - posX[i]) / dist * (minDist - dist) * REPULSION_STRENGTH;
+        float pushY = (posY[j] - posY[i]) / dist * (minDist - dist) * REPULSION_STRENGTH;
+        if ((int) i != draggedId && !asleep[i])
+        {
+            posX[i] -= pushX;
+            posY[i] -= pushY;
+        }
+        if ((int) j != draggedId && !asleep[j])
+        {
+            posX[j] += pushX;
+            posY[j] += pushY;
+        }
+        return (minDist - dist) * REPULSION_STRENGTH;
+    }
+    return 0.F;
+}
+
+void GraphCore::resolveOverlapsBruteForce(int draggedId)
+{
+    for (size_t i = 0; i < posX.size(); i++)
+    {
+        for (size_t j = i + 1; j < posX.size(); j++)
+        {
+            pushApart(i, j, draggedId);
+        }
+    }
+}
+
+// Тот же проход, что и полный перебор, и в том же порядке пар (i, j), но
+// кандидаты берутся из сетки. Пары двух спящих вершин ничего не двигают и
+// не собираются вовсе. Если какая-то вершина ушла дальше запаса, позиции
+// откатываются и вызывающий повторяет проход с большим запасом.
+auto GraphCore::resolveOverlapsGrid(int draggedId, float skin) -> bool
+{
+    startX = posX;
+    startY = posY;
+    travelled.assign(posX.size(), 0.F);
+    overlapGrid.build(startX, startY, 2 * NODE_RADIUS_MAX + 2 + skin);
+
+    overlapPairs.clear();
+    for (size_t i = 0; i < posX.size(); i++)
+    {
+        if (asleep[i]) continue;
+        candidates.clear();
+        overlapGrid.query(startX[i], startY[i], candidates);
+        size_t first = overlapPairs.size();
+        for (int j : candidates)
+        {
+            if (j == (int) i || (j < (int) i && !asleep[j])) continue;
+            auto lo = (uint64_t) std::min((int) i, j), hi = (uint64_t) std::max((int) i, j);
+            overlapPairs.push_back(lo << 32 | hi);
+        }
+        std::sort(overlapPairs.begin() + (ptrdiff_t) first, overlapPairs.end());
+    }
+    // пары со спящей вершиной меньшего номера надо вернуть на её место в порядке
+    if (sleepingCount > 0) std::sort(overlapPairs.begin(), overlapPairs.end());
+
+    for (uint64_t pair : overlapPairs)
+    {
+        auto i = (size_t) (pair >> 32);
+        auto j = (int) (pair & 0xffffffffU);
+        float step = pushApart(i, j, draggedId);
+        if (step == 0.F) continue;
+        if ((int) i != draggedId && !asleep[i]) travelled[i] += step;
+        if (j != draggedId && !asleep[j]) travelled[j] += step;
+        if (travelled[i] > skin / 2 || travelled[j] > skin / 2)
+        {
+            posX = startX;
+            posY = startY;
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Model>
+void GraphCore::buildRepulsionTree(const std::vector<float>& xs, const std::vector<float>& ys)
+{
+    if constexpr (Model::DEGREE_WEIGHTED)
+    {
+        repulsionMass.resize(posX.size());
+        for (size_t i = 0; i < posX.size(); i++)
+        {
+            repulsionMass[i] = (float) incidentEdges[i].size() + 1;
+        }
+        repulsionTree.build(xs, ys, &repulsionMass);
+    }
+    else
+    {
+        repulsionTree.build(xs, ys);
+    }
+}
+
+// Силы считаются по снимку позиций и применяются разом, поэтому результат не
+// зависит от порядка обхода вершин.
+template <typename Model>
+void GraphCore::applyLongRangeRepulsion(int draggedId)
+{
+    startX = posX;
+    startY = posY;
+    buildRepulsionTree<Model>(startX, startY);
+
+    forces.resize(posX.size());
+    for (size_t i = 0; i < posX.size(); i++)
+    {
+        if (asleep[i] || (int) i == draggedId) continue;
+        forces[i] = repulsionTree.repulsion<Model>((int) i, barnesHutTheta, Model::REPULSION);
+    }
+
+    for (size_t i = 0; i < posX.size(); i++)
+    {
+        if (asleep[i] || (int) i == draggedId) continue;
+        float len = std::sqrt(forces[i].x * forces[i].x + forces[i].y * forces[i].y);
+        float scale = len > MAX_REPULSION_STEP ? MAX_REPULSION_STEP / len : 1.F;
+        posX[i] += forces[i].x * scale;
+        posY[i] += forces[i].y * scale;
+    }
+}
+
+template <typename Model>
+void GraphCore::applySprings(int draggedId)
+{
+    for (auto& edge : edges)
+    {
+        int a = edge.firstNodeId, b = edge.secondNodeId;
+        if (asleep[a] && asleep[b]) continue;
+        float dist = distance(posX[a], posY[a], posX[b], posY[b]);
+        if (dist > 0.01f)
+        {
+            float dirX = (posX[b] - posX[a]) / dist;
+            float dirY = (posY[b] - posY[a]) / dist;
+            float force = Model::spring(dist, edge.weight);
+            if (a != draggedId && !asleep[a])
+            {
+                posX[a] += dirX * force;
+                posY[a] += dirY * force;
+            }
+            if (b != draggedId && !asleep[b])
+            {
+                posX[b] -= dirX * force;
+                posY[b] -= dirY * force;
+            }
+        }
+    }
+}
+
+template <typename Model>
+void GraphCore::stepParallel(int draggedId)
+{
+    ThreadPool& workers = threadPool();
+    const ForceKernels& kernels = scalarKernels ? scalarForceKernels() : forceKernels();
+
+    overlapGrid.build(posX, posY, GRID_CELL_SIZE);
+    if (longRange<Model>()) buildRepulsionTree<Model>(posX, posY);
+    computeSpringForces<Model>(kernels);
+
+    awakeIds.clear();
+    for (size_t i = 0; i < posX.size(); i++)
+    {
+        if (!asleep[i] && (int) i != draggedId) awakeIds.push_back((int) i);
+    }
+    deltaX.resize(awakeIds.size());
+    deltaY.resize(awakeIds.size());
+    workers.parallelFor(awakeIds.size(), [this, &kernels](size_t begin, size_t end) {
+        thread_local NeighborBatch batch;
+        for (size_t k = begin; k < end; k++)
+        {
+            Vec2 force = accumulateForce<Model>(awakeIds[k], kernels, batch);
+            deltaX[k] = force.x;
+            deltaY[k] = force.y;
+        }
+    });
+
+    workers.parallelFor(awakeIds.size(), [this](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; k++)
+        {
+            posX[awakeIds[k]] += deltaX[k];
+            posY[awakeIds[k]] += deltaY[k];
+        }
+    });
+}
+
+template <typename Model>
+void GraphCore::computeSpringForces(const ForceKernels& kernels)
+{
+    size_t m = edges.size();
+    for (auto* column : {&springAX, &springAY, &springBX, &springBY, &springRest, &springFX,
+                         &springFY})
+    {
+        column->resize(m);
+    }
+
+    pool->parallelFor(m, [this, &kernels](size_t begin, size_t end) {
+        for (size_t e = begin; e < end; e++)
+        {
+            springAX[e] = posX[edges[e].firstNodeId];
+            springAY[e] = posY[edges[e].firstNodeId];
+            springBX[e] = posX[edges[e].secondNodeId];
+            springBY[e] = posY[edges[e].secondNodeId];
+            springRest[e] = edges[e].weight;
+        }
+        if constexpr (Model::VECTOR_SPRINGS)
+        {
+            kernels.springs(&springAX[begin], &springAY[begin], &springBX[begin],
+                            &springBY[begin], &springRest[begin], &springFX[begin],
+                            &springFY[begin], end - begin, Model::SPRING);
+        }
+        else
+        {
+            springForces<Model>(&springAX[begin], &springAY[begin], &springBX[begin],
+                                &springBY[begin], &springRest[begin], &springFX[begin],
+                                &springFY[begin], end - begin);
+        }
+    });
+}
+
+// Сумма всех сил на одну вершину. Каждая вершина собирает вклады сама
+// (пары считаются с обеих сторон), поэтому потоки пишут только свои ячейки,
+// а порядок сложения фиксирован.
+template <typename Model>
+auto GraphCore::accumulateForce(int id, const ForceKernels& kernels, NeighborBatch& batch) const
+    -> Vec2
+{
+    Vec2 force;
+    float x = posX[id], y = posY[id];
+
+    if (longRange<Model>())
+    {
+        force = repulsionTree.repulsion<Model>(id, barnesHutTheta, Model::REPULSION);
+        float len = std::sqrt(force.x * force.x + force.y * force.y);
+        float scale = len > MAX_REPULSION_STEP ? MAX_REPULSION_STEP / len : 1.F;
+        force.x *= scale;
+        force.y *= scale;
+    }
+
+    batch.ids.clear();
+    overlapGrid.query(x, y, batch.ids);
+    size_t count = batch.ids.size();
+    for (auto* column : {&batch.x, &batch.y, &batch.r, &batch.pushX, &batch.pushY})
+    {
+        column->resize(count);
+    }
+    for (size_t k = 0; k < count; k++)
+    {
+        batch.x[k] = posX[batch.ids[k]];
+        batch.y[k] = posY[batch.ids[k]];
+        batch.r[k] = radius[batch.ids[k]];
+    }
+    kernels.overlap(x, y, radius[id], batch.x.data(), batch.y.data(), batch.r.data(),
+                    batch.pushX.data(), batch.pushY.data(), count, REPULSION_STRENGTH);
+    for (size_t k = 0; k < count; k++)
+    {
+        force.x += batch.pushX[k];
+        force.y += batch.pushY[k];
+    }
+
+    for (int e : incidentEdges[id])
+    {
+        if (edges[e].firstNodeId == id)
+        {
+            force.x += springFX[e];
+            force.y += springFY[e];
+        }
+        else
+        {
+            force.x -= springFX[e];
+            force.y -= springFY[e];
+        }
+    }
+    return force;
+}
+
+void GraphCore::clear()
+{
+    posX.clear();
+    posY.clear();
+    radius.clear();
+    growing.clear();
+    growingIds.clear();
+    asleep.clear();
+    quietSteps.clear();
+    sleepingCount = 0;
+    changedIds.clear();
+    changedSlot.clear();
+    incidentEdges.clear();
+    nodeHandles.clear();
+    edgeHandles.clear();
+    components.reset(0);
+    componentsDirty = false;
+    edges.clear();
+    edgeIndex.clear();
+    pickIndex.clear();
+    pickIndexDirty = false;
+    pathsDirty = true;
+    positionsVersion++;
+}
+
+// Списки рёбер вершин - данные рёбер: на ребро приходится по записи у каждого конца.
+auto GraphCore::memoryStats() const -> MemoryStats
+{
+    MemoryStats stats;
+    stats.nodes = posX.size();
+    stats.edges = edges.size();
+
+    size_t edgeHeads = incidentEdges.capacity() * sizeof(incidentEdges[0]);
+    stats.nodeBytes = vectorBytes(posX) + vectorBytes(posY) + vectorBytes(radius) +
+                      vectorBytes(growing) + vectorBytes(growingIds) + vectorBytes(asleep) +
+                      vectorBytes(quietSteps) + vectorBytes(changedIds) + vectorBytes(changedSlot) +
+                      edgeHeads + nodeHandles.memoryBytes() + components.memoryBytes();
+    stats.edgeBytes = vectorBytes(edges) + vectorBytes(incidentEdges) - edgeHeads +
+                      edgeHandles.memoryBytes();
+    stats.indexBytes = edgeIndex.memoryBytes() + pickIndex.memoryBytes() + paths.memoryBytes();
+    stats.scratchBytes =
+        overlapGrid.memoryBytes() + repulsionTree.memoryBytes() + vectorBytes(repulsionMass) +
+        vectorBytes(startX) + vectorBytes(startY) + vectorBytes(travelled) + vectorBytes(forces) +
+        vectorBytes(candidates) + vectorBytes(overlapPairs) + vectorBytes(stepStartX) +
+        vectorBytes(stepStartY) + vectorBytes(awakeIds) + vectorBytes(movingIds) +
+        vectorBytes(deltaX) + vectorBytes(deltaY) + vectorBytes(springAX) + vectorBytes(springAY) +
+        vectorBytes(springBX) + vectorBytes(springBY) + vectorBytes(springRest) +
+        vectorBytes(springFX) + vectorBytes(springFY) + spanningForest.memoryBytes() +
+        multilevel.memoryBytes();
+    return stats;
+}
+
+auto GraphCore::save(const std::string& path) const -> bool
+{
+    const std::vector<uint64_t>& slots = edgeIndex.slotData();
+    GraphFileHeader header = graphFileLayout(posX.size(), edges.size(), slots.size());
+
+    // пишем во временный файл и подменяем им старый, чтобы сбой не испортил сохранение
+    std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) return false;
+
+    uint64_t written = 0;
+    auto write = [&](uint64_t offset, const void* bytes, size_t count) {
+        static constexpr char PADDING[GRAPH_FILE_ALIGNMENT] = {};
+        size_t gap = (size_t) (offset - written);
+        written = offset + count;
+        return std::fwrite(PADDING, 1, gap, file) == gap &&
+               std::fwrite(bytes, 1, count, file) == count;
+    };
+
+    size_t n = posX.size();
+    bool ok = write(0, &header, sizeof(header)) &&
+              write(header.posXOffset, posX.data(), n * sizeof(float)) &&
+              write(header.posYOffset, posY.data(), n * sizeof(float)) &&
+              write(header.radiusOffset, radius.data(), n * sizeof(float));
+
+    std::vector<GraphFileEdge> chunk;
+    for (size_t begin = 0; ok && begin < edges.size(); begin += SAVE_CHUNK_EDGES)
+    {
+        size_t end = std::min(edges.size(), begin + SAVE_CHUNK_EDGES);
+        chunk.clear();
+        for (size_t e = begin; e < end; e++)
+        {
+            chunk.push_back({edges[e].firstNodeId, edges[e].secondNodeId, edges[e].weight});
+        }
+        ok = write(header.edgesOffset + begin * sizeof(GraphFileEdge), chunk.data(),
+                   chunk.size() * sizeof(GraphFileEdge));
+    }
+    ok = ok && write(header.slotsOffset, slots.data(), slots.size() * sizeof(uint64_t));
+
+    ok = std::fclose(file) == 0 && ok;
+    ok = ok && std::rename(temporary.c_str(), path.c_str()) == 0;
+    if (!ok) std::remove(temporary.c_str());
+    return ok;
+}
+
+// Массивы вершин копируются из отображения целиком, рёбра - одним проходом
+// с проверкой номеров концов и сбором списков смежности, хеш рёбер берётся
+// готовым. Сетка выбора и индекс путей строятся при первом обращении.
+auto GraphCore::load(const std::string& path) -> bool
+{
+    MappedGraphFile file;
+    if (!file.open(path)) return false;
+
+    size_t n = file.nodeCount();
+    std::vector<Edge> loaded;
+    loaded.reserve(file.edgeCount());
+    for (size_t e = 0; e < file.edgeCount(); e++)
+    {
+        const GraphFileEdge& edge = file.edges()[e];
+        if (edge.firstNodeId < 0 || (size_t) edge.firstNodeId >= n || edge.secondNodeId < 0 ||
+            (size_t) edge.secondNodeId >= n)
+        {
+            return false;
+        }
+        loaded.emplace_back(edge.firstNodeId, edge.secondNodeId, edge.weight);
+    }
+    // таблица берётся готовой, но сверяется с рёбрами: устаревшая или
+    // испорченная дала бы неверные hasEdge и addEdge
+    EdgeIndex index;
+    if (!index.assign(file.slots(), file.slotCount(), loaded.size()) ||
+        !index.holdsExactly(loaded))
+    {
+        return false;
+    }
+
+    clear();
+    posX.assign(file.posX(), file.posX() + n);
+    posY.assign(file.posY(), file.posY() + n);
+    radius.assign(file.radius(), file.radius() + n);
+    positionsVersion++;
+    growing.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        growing[i] = radius[i] < NODE_RADIUS_MAX;
+        if (growing[i]) growingIds.push_back((int) i);
+    }
+    asleep.assign(n, 0);
+    quietSteps.assign(n, 0);
+    changedIds.resize(n);
+    changedSlot.resize(n);
+    incidentEdges.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        changedIds[i] = changedSlot[i] = (int) i;
+        nodeHandles.add();
+    }
+    edges = std::move(loaded);
+    edgeIndex = std::move(index);
+    componentsDirty = true;
+    for (size_t e = 0; e < edges.size(); e++)
+    {
+        incidentEdges[edges[e].firstNodeId].push_back((int) e);
+        if (edges[e].secondNodeId != edges[e].firstNodeId)
+            incidentEdges[edges[e].secondNodeId].push_back((int) e);
+        edgeHandles.add();
+    }
+    pickIndexDirty = true;
+    return true;
+}
+
+void GraphCore::importGraph(const ImportedGraph& imported)
+{
+    clear();
+    size_t n = imported.nodeCount;
+    std::vector<float> xs(n), ys(n);
+    std::mt19937 rng(IMPORT_SEED);
+    std::uniform_real_distribution<float> coordinate(0, std::sqrt((float) n) * IMPORT_SPACING);
+    for (size_t i = 0; i < n; i++)
+    {
+        xs[i] = coordinate(rng);
+        ys[i] = coordinate(rng);
+    }
+    addNodes(xs.data(), ys.data(), n);
+
+    // пары уже отсортированы и без повторов, поэтому номера рёбер совпадают
+    // с их местом в imported
+    addEdges(imported.pairs.data(), imported.pairs.size());
+    for (size_t e = 0; e < imported.weights.size() && e < edges.size(); e++)
+    {
+        if (!std::isnan(imported.weights[e])) edges[e].weight = imported.weights[e];
+    }
+}
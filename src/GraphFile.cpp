@@ -0,0 +1,87 @@
+#include "GraphFile.hpp"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+auto align(uint64_t offset) -> uint64_t
+{
+    return (offset + GRAPH_FILE_ALIGNMENT - 1) / GRAPH_FILE_ALIGNMENT * GRAPH_FILE_ALIGNMENT;
+}
+}  // namespace
+
+auto graphFileLayout(uint64_t nodeCount, uint64_t edgeCount, uint64_t slotCount)
+    -> GraphFileHeader
+{
+    GraphFileHeader header{};
+    std::memcpy(header.magic, GRAPH_FILE_MAGIC, sizeof(header.magic));
+    header.version = GRAPH_FILE_VERSION;
+    header.byteOrder = GRAPH_FILE_BYTE_ORDER;
+    header.nodeCount = nodeCount;
+    header.edgeCount = edgeCount;
+    header.slotCount = slotCount;
+
+    header.posXOffset = align(sizeof(GraphFileHeader));
+    header.posYOffset = align(header.posXOffset + nodeCount * sizeof(float));
+    header.radiusOffset = align(header.posYOffset + nodeCount * sizeof(float));
+    header.edgesOffset = align(header.radiusOffset + nodeCount * sizeof(float));
+    header.slotsOffset = align(header.edgesOffset + edgeCount * sizeof(GraphFileEdge));
+    header.fileSize = header.slotsOffset + slotCount * sizeof(uint64_t);
+    return header;
+}
+
+MappedGraphFile::~MappedGraphFile()
+{
+    close();
+}
+
+auto MappedGraphFile::open(const std::string& path) -> bool
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info = {};
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(GraphFileHeader))
+    {
+        ::close(fd);
+        return false;
+    }
+    size = (size_t) info.st_size;
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        data = nullptr;
+        return false;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    // заголовок должен совпасть с раскладкой, посчитанной заново по его же
+    // размерам; размеры сначала ограничиваются файлом, чтобы не переполниться
+    header = static_cast<const GraphFileHeader*>(data);
+    bool valid = std::memcmp(header->magic, GRAPH_FILE_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->version == GRAPH_FILE_VERSION &&
+                 header->byteOrder == GRAPH_FILE_BYTE_ORDER && header->nodeCount <= size &&
+                 header->edgeCount <= size && header->slotCount <= size;
+    if (valid)
+    {
+        GraphFileHeader expected =
+            graphFileLayout(header->nodeCount, header->edgeCount, header->slotCount);
+        valid = std::memcmp(&expected, header, sizeof(GraphFileHeader)) == 0 &&
+                header->fileSize == size;
+    }
+    if (!valid) close();
+    return valid;
+}
+
+void MappedGraphFile::close()
+{
+    if (data != nullptr) munmap(data, size);
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+}
@@ -0,0 +1,308 @@
+#include "MultilevelLayout.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+// огрубление идёт до COARSEST_NODES вершин или пока уровень сжимается хотя бы
+// до MAX_COARSEN_RATIO от предыдущего (одиночные вершины не сливаются)
+constexpr size_t COARSEST_NODES = 64;
+constexpr float MAX_COARSEN_RATIO = 0.9F;
+constexpr size_t MAX_LEVELS = 40;
+
+constexpr int COARSEST_ITERATIONS = 300;
+constexpr int REFINE_ITERATIONS = 40;
+// вершина сдвигается на температуру вдоль суммарной силы; температура в
+// долях средней длины ребра уровня и к концу уровня остывает в 100 раз
+constexpr float COARSEST_TEMPERATURE = 2.F;
+constexpr float REFINE_TEMPERATURE = 0.5F;
+constexpr float FINAL_COOLING = 0.01F;
+
+// силы - из модели, поделённые на её SPRING: сдвиг меряется температурой, и
+// без этого шаг зависел бы от жёсткости модели. Отталкивание уровня -
+// Model::REPULSION * (meanRest / meanRest исходного уровня)^2
+constexpr float BARNES_HUT_THETA = 0.8F;
+constexpr float MIN_REST = 1.F;
+constexpr float DEFAULT_REST = 40.F;
+constexpr float MIN_DIST = 0.01F;
+
+namespace
+{
+struct Link
+{
+    int first, second;
+    float unitRest;
+};
+
+// Рёбра уровня в CSR. Кратные рёбра сливаются, их длины усредняются; длина
+// задана на одну вершину массы 1 и растёт с корнями масс концов.
+void connect(std::vector<Link>& links, std::vector<uint32_t>& start, std::vector<int>& neighbors,
+             std::vector<float>& rest, const std::vector<float>& mass, float& meanRest)
+{
+    std::sort(links.begin(), links.end(), [](const Link& a, const Link& b) {
+        return a.first != b.first ? a.first < b.first : a.second < b.second;
+    });
+    size_t merged = 0;
+    for (size_t k = 0; k < links.size();)
+    {
+        size_t end = k;
+        double sum = 0;
+        while (end < links.size() && links[end].first == links[k].first &&
+               links[end].second == links[k].second)
+            sum += links[end++].unitRest;
+        links[merged] = links[k];
+        links[merged++].unitRest = (float) (sum / (double) (end - k));
+        k = end;
+    }
+    links.resize(merged);
+
+    start.assign(mass.size() + 1, 0);
+    for (const Link& link : links)
+    {
+        start[link.first + 1]++;
+        start[link.second + 1]++;
+    }
+    for (size_t i = 0; i < mass.size(); i++) start[i + 1] += start[i];
+    neighbors.resize(start.back());
+    rest.resize(start.back());
+
+    std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+    double total = 0;
+    for (const Link& link : links)
+    {
+        float length = link.unitRest *
+                       (std::sqrt(mass[link.first]) + std::sqrt(mass[link.second])) / 2;
+        total += length;
+        neighbors[fill[link.first]] = link.second;
+        rest[fill[link.first]++] = length;
+        neighbors[fill[link.second]] = link.first;
+        rest[fill[link.second]++] = length;
+    }
+    meanRest = links.empty() ? DEFAULT_REST : (float) (total / (double) links.size());
+}
+
+// точка в круге радиуса radius, своя для каждой вершины и одна и та же при
+// каждом запуске: золотой угол и корень номера
+auto spread(int id, size_t count, float radius) -> Vec2
+{
+    constexpr float GOLDEN_ANGLE = 2.39996323F;
+    float distance = radius * std::sqrt(((float) (id % (int) count) + 0.5F) / (float) count);
+    return {distance * std::cos(GOLDEN_ANGLE * (float) id),
+            distance * std::sin(GOLDEN_ANGLE * (float) id)};
+}
+}  // namespace
+
+template <typename Model>
+void MultilevelLayout::run(const std::vector<Edge>& edges, std::vector<float>& xs,
+                           std::vector<float>& ys, ThreadPool& pool)
+{
+    size_t n = xs.size();
+    if (n == 0) return;
+
+    levels.resize(1);
+    Level& base = levels[0];
+    base.x = xs;
+    base.y = ys;
+    base.mass.assign(n, 1.F);
+    std::vector<Link> links;
+    links.reserve(edges.size());
+    for (const Edge& edge : edges)
+    {
+        int a = edge.firstNodeId, b = edge.secondNodeId;
+        if (a == b) continue;
+        links.push_back({std::min(a, b), std::max(a, b), std::max(edge.weight, MIN_REST)});
+    }
+    connect(links, base.start, base.neighbors, base.rest, base.mass, base.meanRest);
+    base.charge.resize(n);
+    for (size_t i = 0; i < n; i++) base.charge[i] = (float) (base.start[i + 1] - base.start[i] + 1);
+
+    while (levels.size() < MAX_LEVELS && levels.back().x.size() > COARSEST_NODES)
+    {
+        levels.emplace_back();
+        Level& fine = levels[levels.size() - 2];
+        Level& coarse = levels.back();
+        coarsen(fine, coarse);
+        if ((float) coarse.x.size() > MAX_COARSEN_RATIO * (float) fine.x.size())
+        {
+            levels.pop_back();
+            break;
+        }
+    }
+
+    // группы грубого уровня могли сойтись в одну точку: разносим их по кругу
+    Level& coarsest = levels.back();
+    size_t count = coarsest.x.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        Vec2 offset = spread((int) i, count, coarsest.meanRest * std::sqrt((float) count) / 2);
+        coarsest.x[i] += offset.x;
+        coarsest.y[i] += offset.y;
+    }
+    refine<Model>(coarsest, COARSEST_ITERATIONS, COARSEST_TEMPERATURE * coarsest.meanRest, pool);
+
+    for (size_t l = levels.size() - 1; l-- > 0;)
+    {
+        Level& fine = levels[l];
+        const Level& coarse = levels[l + 1];
+        for (size_t i = 0; i < fine.x.size(); i++)
+        {
+            int p = fine.parent[i];
+            // члены группы - по кругу размером с группу
+            Vec2 offset = spread((int) i, (size_t) coarse.mass[p] + 1,
+                                 fine.meanRest * std::sqrt(coarse.mass[p] / fine.mass[i]) / 2);
+            fine.x[i] = coarse.x[p] + offset.x;
+            fine.y[i] = coarse.y[p] + offset.y;
+        }
+        refine<Model>(fine, REFINE_ITERATIONS, REFINE_TEMPERATURE * fine.meanRest, pool);
+    }
+
+    xs = levels[0].x;
+    ys = levels[0].y;
+}
+
+// Вершины обходятся в случайном порядке (с постоянным зерном): при обходе по
+// номерам или степеням пары выстраиваются полосами, и грубый граф решётки
+// выходит изогнутым. Вершина без свободных соседей уходит в самую лёгкую
+// соседнюю группу, иначе звезда сжималась бы на одну вершину за уровень.
+void MultilevelLayout::coarsen(Level& fine, Level& coarse)
+{
+    size_t n = fine.x.size();
+    order.resize(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937((uint32_t) levels.size()));
+
+    fine.parent.assign(n, -1);
+    coarse.mass.clear();
+    for (int u : order)
+    {
+        if (fine.parent[u] != -1) continue;
+        int free = -1, joined = -1;
+        for (uint32_t k = fine.start[u]; k < fine.start[u + 1]; k++)
+        {
+            int v = fine.neighbors[k];
+            if (fine.parent[v] == -1)
+            {
+                if (free == -1 || fine.mass[v] < fine.mass[free]) free = v;
+            }
+            else if (joined == -1 || coarse.mass[fine.parent[v]] < coarse.mass[joined])
+            {
+                joined = fine.parent[v];
+            }
+        }
+        if (free != -1)
+        {
+            fine.parent[u] = fine.parent[free] = (int) coarse.mass.size();
+            coarse.mass.push_back(fine.mass[u] + fine.mass[free]);
+        }
+        else if (joined != -1)
+        {
+            fine.parent[u] = joined;
+            coarse.mass[joined] += fine.mass[u];
+        }
+        else
+        {
+            fine.parent[u] = (int) coarse.mass.size();
+            coarse.mass.push_back(fine.mass[u]);
+        }
+    }
+
+    size_t m = coarse.mass.size();
+    coarse.x.assign(m, 0.F);
+    coarse.y.assign(m, 0.F);
+    coarse.charge.assign(m, 0.F);
+    for (size_t i = 0; i < n; i++)
+    {
+        int p = fine.parent[i];
+        coarse.x[p] += fine.x[i] * fine.mass[i] / coarse.mass[p];
+        coarse.y[p] += fine.y[i] * fine.mass[i] / coarse.mass[p];
+        coarse.charge[p] += fine.charge[i] * fine.mass[i] / coarse.mass[p];
+    }
+
+    std::vector<Link> links;
+    for (size_t u = 0; u < n; u++)
+    {
+        for (uint32_t k = fine.start[u]; k < fine.start[u + 1]; k++)
+        {
+            auto v = (size_t) fine.neighbors[k];
+            int a = fine.parent[u], b = fine.parent[v];
+            if (u > v || a == b) continue;
+            float unit = fine.rest[k] * 2 / (std::sqrt(fine.mass[u]) + std::sqrt(fine.mass[v]));
+            links.push_back({std::min(a, b), std::max(a, b), unit});
+        }
+    }
+    connect(links, coarse.start, coarse.neighbors, coarse.rest, coarse.mass, coarse.meanRest);
+}
+
+// Шаг Якоби: силы по снимку позиций, затем все сдвиги разом - результат не
+// зависит от числа потоков.
+template <typename Model>
+void MultilevelLayout::refine(Level& level, int iterations, float temperature, ThreadPool& pool)
+{
+    size_t n = level.x.size();
+    float ratio = level.meanRest / levels[0].meanRest;
+    float strength = Model::REPULSION * ratio * ratio / Model::SPRING;
+    float cooling = std::pow(FINAL_COOLING, 1.F / (float) iterations);
+    deltaX.resize(n);
+    deltaY.resize(n);
+
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        tree.build(level.x, level.y, Model::DEGREE_WEIGHTED ? &level.charge : nullptr);
+        pool.parallelFor(n, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                float x = level.x[i], y = level.y[i];
+                Vec2 force = tree.repulsion<Model>((int) i, BARNES_HUT_THETA, strength);
+                for (uint32_t k = level.start[i]; k < level.start[i + 1]; k++)
+                {
+                    int j = level.neighbors[k];
+                    float dx = level.x[j] - x, dy = level.y[j] - y;
+                    float dist = std::sqrt(dx * dx + dy * dy);
+                    if (dist < MIN_DIST) continue;
+                    float pull = Model::spring(dist, level.rest[k]) / Model::SPRING;
+                    force.x += dx / dist * pull;
+                    force.y += dy / dist * pull;
+                }
+
+                float len = std::sqrt(force.x * force.x + force.y * force.y);
+                float scale = len > 0 ? std::min(temperature, len) / len : 0.F;
+                deltaX[i] = force.x * scale;
+                deltaY[i] = force.y * scale;
+            }
+        });
+
+        for (size_t i = 0; i < n; i++)
+        {
+            level.x[i] += deltaX[i];
+            level.y[i] += deltaY[i];
+        }
+        temperature *= cooling;
+    }
+}
+
+template void MultilevelLayout::run<LinearSpring>(const std::vector<Edge>& edges,
+                                                 std::vector<float>& xs, std::vector<float>& ys,
+                                                 ThreadPool& pool);
+template void MultilevelLayout::run<LogSpring>(const std::vector<Edge>& edges,
+                                              std::vector<float>& xs, std::vector<float>& ys,
+                                              ThreadPool& pool);
+template void MultilevelLayout::run<FruchtermanReingold>(const std::vector<Edge>& edges,
+                                                        std::vector<float>& xs,
+                                                        std::vector<float>& ys, ThreadPool& pool);
+template void MultilevelLayout::run<ForceAtlas2>(const std::vector<Edge>& edges,
+                                                std::vector<float>& xs, std::vector<float>& ys,
+                                                ThreadPool& pool);
+
+auto MultilevelLayout::memoryBytes() const -> size_t
+{
+    size_t bytes = vectorBytes(levels) + tree.memoryBytes() + vectorBytes(order) +
+                   vectorBytes(deltaX) + vectorBytes(deltaY);
+    for (const Level& level : levels)
+    {
+        bytes += vectorBytes(level.x) + vectorBytes(level.y) + vectorBytes(level.mass) +
+                 vectorBytes(level.charge) + vectorBytes(level.start) +
+                 vectorBytes(level.neighbors) + vectorBytes(level.rest) +
+                 vectorBytes(level.parent);
+    }
+    return bytes;
+}
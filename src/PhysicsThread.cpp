@@ -0,0 +1,170 @@
+#include "PhysicsThread.hpp"
+
+constexpr unsigned FRAME_INDEX = 3;
+constexpr unsigned FRESH = 4;
+
+PhysicsThread::PhysicsThread(GraphCore& core, double stepSeconds, FrameProfiler* profiler)
+    : core(core), stepTime(stepSeconds), profiler(profiler), worker([this] { run(); })
+{
+}
+
+PhysicsThread::~PhysicsThread()
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    worker.join();
+}
+
+// Отпускание, которое уже отправлено, не будит поток: окно зовёт drag каждый
+// кадр. Счётчик растёт до чтения idle, а поток ставит idle до проверки
+// счётчика (оба seq_cst), поэтому кто-то из двух видит другого.
+auto PhysicsThread::drag(NodeHandle node, float x, float y) -> bool
+{
+    if (node == NodeHandle() && sentNode == NodeHandle()) return true;
+    if (!drags.push({node, x, y})) return false;
+    sentNode = node;
+    requests.fetch_add(1);
+    if (idle.load())
+    {
+        // поток мог проверить счётчик и ещё не заснуть: ждём, пока он отпустит mutex
+        std::lock_guard<std::mutex> guard(mutex);
+    }
+    wakeup.notify_one();
+    return true;
+}
+
+auto PhysicsThread::latestFrame() -> const Frame&
+{
+    if (ready.load(std::memory_order_acquire) & FRESH)
+    {
+        front = ready.exchange(front, std::memory_order_acq_rel) & FRAME_INDEX;
+    }
+    return frames[front];
+}
+
+// Изменения шага запоминаются для всех трёх буферов, а в пишущийся
+// переносятся накопленные для него; новые вершины тоже помечены изменившимися.
+void PhysicsThread::copyChanged(Frame& frame)
+{
+    size_t n = core.nodeCount();
+    for (unsigned k = 0; k < 3; k++)
+    {
+        if (staleMark[k].size() < n) staleMark[k].resize(n, 0);
+        for (int id : core.changedNodes())
+        {
+            if (staleMark[k][id]) continue;
+            staleMark[k][id] = 1;
+            staleIds[k].push_back(id);
+        }
+    }
+    frame.posX.resize(n);
+    frame.posY.resize(n);
+    frame.radius.resize(n);
+    for (int id : staleIds[back])
+    {
+        staleMark[back][id] = 0;
+        if ((size_t) id >= n) continue;
+        frame.posX[id] = core.posX[id];
+        frame.posY[id] = core.posY[id];
+        frame.radius[id] = core.radius[id];
+    }
+    staleIds[back].clear();
+}
+
+// Пока опубликованный кадр не забран, его изменения переносятся в следующий:
+// отрисовка его пропустит. Если отрисовка заберёт кадр между проверкой и
+// публикацией, список выйдет лишь шире нужного.
+void PhysicsThread::collectDirty(Frame& frame)
+{
+    if (!(ready.load(std::memory_order_acquire) & FRESH))
+    {
+        for (int id : carriedIds) carriedMark[id] = 0;
+        carriedIds.clear();
+    }
+    if (carriedMark.size() < core.nodeCount()) carriedMark.resize(core.nodeCount(), 0);
+    for (int id : core.changedNodes())
+    {
+        if (carriedMark[id]) continue;
+        carriedMark[id] = 1;
+        carriedIds.push_back(id);
+    }
+    core.clearChanged();
+    frame.dirtyIds.assign(carriedIds.begin(), carriedIds.end());
+}
+
+void PhysicsThread::publish()
+{
+    back = ready.exchange(back | FRESH, std::memory_order_acq_rel) & FRAME_INDEX;
+}
+
+// Шаг, который не уложился во время, не догоняется следующими: отставание
+// сбрасывается, иначе медленная раскладка уходила бы в бесконечную очередь шагов.
+void PhysicsThread::run()
+{
+    using Clock = std::chrono::steady_clock;
+    auto period = std::chrono::duration_cast<Clock::duration>(stepTime);
+    auto next = Clock::now();
+    NodeHandle dragged;
+    float dragX = 0, dragY = 0;
+    uint64_t steps = 0;
+    bool wasSettled = false;
+    size_t publishedNodes = 0;
+
+    while (!stopping)
+    {
+        uint64_t seen = requests.load();
+        DragEvent event{};
+        while (drags.pop(event))
+        {
+            dragged = event.node;
+            dragX = event.x;
+            dragY = event.y;
+        }
+
+        bool changed = true;
+        bool quiet = false;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            FrameProfiler::Scope scope(profiler, Phase::Physics);
+            // номер - под блокировкой: между событием и шагом вершины могли удалить
+            int draggedId = core.nodeId(dragged);
+            if (draggedId != -1) core.moveNode(draggedId, dragX, dragY);
+            core.step(draggedId);
+            core.growNodes();
+
+            // уснувший граф не меняется: последний кадр уже опубликован
+            bool settled = core.awakeCount() == 0;
+            quiet = settled && draggedId == -1 && core.growingCount() == 0;
+            changed = !(settled && wasSettled && publishedNodes == core.nodeCount());
+            wasSettled = settled;
+            if (changed)
+            {
+                Frame& frame = frames[back];
+                copyChanged(frame);
+                collectDirty(frame);
+                frame.step = ++steps;
+                publishedNodes = core.nodeCount();
+            }
+        }
+        if (changed) publish();
+
+        // последний кадр опубликован, дальше граф сам не изменится
+        if (quiet && !changed)
+        {
+            std::unique_lock<std::mutex> guard(mutex);
+            idle = true;
+            wakeup.wait(guard, [&] { return stopping || requests.load() != seen; });
+            idle = false;
+            next = Clock::now();
+            continue;
+        }
+
+        next += period;
+        auto now = Clock::now();
+        if (next < now) next = now;
+        std::this_thread::sleep_until(next);
+    }
+}
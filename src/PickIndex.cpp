@@ -0,0 +1,246 @@
+#include "PickIndex.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+auto pack(int32_t cx, int32_t cy) -> uint64_t
+{
+    return ((uint64_t) (uint32_t) cx << 32) | (uint32_t) cy;
+}
+
+auto unpackX(uint64_t key) -> int32_t
+{
+    return (int32_t) (uint32_t) (key >> 32);
+}
+
+auto unpackY(uint64_t key) -> int32_t
+{
+    return (int32_t) (uint32_t) key;
+}
+
+auto coarsen(uint64_t key, size_t level) -> uint64_t
+{
+    return pack(unpackX(key) >> level, unpackY(key) >> level);
+}
+
+void erase(std::vector<int>& list, int id)
+{
+    auto it = std::find(list.begin(), list.end(), id);
+    if (it == list.end()) return;
+    *it = list.back();
+    list.pop_back();
+}
+}  // namespace
+
+auto PickIndex::cellOf(float x, float y) -> uint64_t
+{
+    return pack((int32_t) std::floor(x / CELL_SIZE), (int32_t) std::floor(y / CELL_SIZE));
+}
+
+void PickIndex::clear()
+{
+    levels.clear();
+    nodeCell.clear();
+    nodeEdges.clear();
+    edgeEnds.clear();
+    edgeVersion.clear();
+}
+
+void PickIndex::addNode(int id, float x, float y)
+{
+    nodeCell.resize(std::max(nodeCell.size(), (size_t) id + 1));
+    nodeEdges.resize(nodeCell.size());
+    nodeCell[id] = cellOf(x, y);
+    if (levels.empty()) levels.resize(1);
+    levels[0][nodeCell[id]].nodes.push_back(id);
+}
+
+auto PickIndex::moveNode(int id, float x, float y) -> bool
+{
+    uint64_t cell = cellOf(x, y);
+    if (cell == nodeCell[id]) return false;
+
+    for (int e : nodeEdges[id]) removeEdge(e);
+    erase(levels[0][nodeCell[id]].nodes, id);
+    nodeCell[id] = cell;
+    levels[0][cell].nodes.push_back(id);
+    for (int e : nodeEdges[id]) insertEdge(e);
+    return true;
+}
+
+void PickIndex::addEdge(int id, int firstNodeId, int secondNodeId)
+{
+    edgeEnds.resize(std::max(edgeEnds.size(), (size_t) id + 1));
+    edgeVersion.resize(edgeEnds.size());
+    edgeEnds[id] = {firstNodeId, secondNodeId};
+    nodeEdges[firstNodeId].push_back(id);
+    if (secondNodeId != firstNodeId) nodeEdges[secondNodeId].push_back(id);
+    insertEdge(id);
+}
+
+void PickIndex::eraseNode(int id)
+{
+    erase(levels[0][nodeCell[id]].nodes, id);
+    nodeEdges[id].clear();
+}
+
+// Записи рёбер хранят номера рёбер, а не вершин, и ячейки у вершины те же:
+// перерегистрировать ничего не нужно.
+void PickIndex::renameNode(int from, int to)
+{
+    auto& cellNodes = levels[0][nodeCell[from]].nodes;
+    *std::find(cellNodes.begin(), cellNodes.end(), from) = to;
+    nodeCell[to] = nodeCell[from];
+    for (int e : nodeEdges[from])
+    {
+        if (edgeEnds[e].first == from) edgeEnds[e].first = to;
+        if (edgeEnds[e].second == from) edgeEnds[e].second = to;
+    }
+    nodeEdges[to] = std::move(nodeEdges[from]);
+    nodeEdges[from].clear();
+}
+
+void PickIndex::eraseEdge(int id)
+{
+    removeEdge(id);
+    erase(nodeEdges[edgeEnds[id].first], id);
+    erase(nodeEdges[edgeEnds[id].second], id);
+}
+
+// Версии не сбрасываются: записи обоих номеров до переименования устаревают.
+void PickIndex::renameEdge(int from, int to)
+{
+    auto [first, second] = edgeEnds[from];
+    eraseEdge(from);
+    addEdge(to, first, second);
+}
+
+// Уровень ребра - первый, на котором концы отстоят не больше чем на
+// MAX_EDGE_SPAN ячеек. На нём берутся ячейки вдоль отрезка между центрами
+// ячеек концов, расширенные на одну. Вместе с запросом 3x3 это покрывает
+// любую точку в пределах CELL_SIZE от ребра, где бы внутри своих ячеек ни
+// находились концы.
+auto PickIndex::coveredCells(int edgeId, std::vector<uint64_t>& out) const -> size_t
+{
+    uint64_t a = nodeCell[edgeEnds[edgeId].first];
+    uint64_t b = nodeCell[edgeEnds[edgeId].second];
+
+    size_t level = 0;
+    int32_t dx = unpackX(b) - unpackX(a), dy = unpackY(b) - unpackY(a);
+    while (std::max(std::abs(dx), std::abs(dy)) > MAX_EDGE_SPAN)
+    {
+        level++;
+        dx = unpackX(coarsen(b, level)) - unpackX(coarsen(a, level));
+        dy = unpackY(coarsen(b, level)) - unpackY(coarsen(a, level));
+    }
+
+    int32_t ax = unpackX(coarsen(a, level)), ay = unpackY(coarsen(a, level));
+    int32_t steps = std::max(std::abs(dx), std::abs(dy));
+    out.clear();
+    for (int32_t t = 0; t <= steps; t++)
+    {
+        int32_t cx = ax, cy = ay;
+        if (steps > 0)
+        {
+            cx += (int32_t) std::lround((double) dx * t / steps);
+            cy += (int32_t) std::lround((double) dy * t / steps);
+        }
+        for (int32_t oy = -1; oy <= 1; oy++)
+        {
+            for (int32_t ox = -1; ox <= 1; ox++) out.push_back(pack(cx + ox, cy + oy));
+        }
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return level;
+}
+
+void PickIndex::insertEdge(int edgeId)
+{
+    size_t level = coveredCells(edgeId, scratch);
+    if (levels.size() <= level) levels.resize(level + 1);
+    for (uint64_t cell : scratch)
+    {
+        levels[level][cell].edges.push_back({edgeId, edgeVersion[edgeId]});
+    }
+}
+
+// Записи ребра не ищутся в ячейках: версия ребра увеличивается, и старые
+// записи становятся устаревшими. Ячейка чистится, когда их больше половины.
+void PickIndex::removeEdge(int edgeId)
+{
+    size_t level = coveredCells(edgeId, scratch);
+    edgeVersion[edgeId]++;
+    for (uint64_t key : scratch)
+    {
+        auto it = levels[level].find(key);
+        if (it == levels[level].end()) continue;
+
+        Cell& cell = it->second;
+        if (2 * ++cell.staleEdges <= cell.edges.size()) continue;
+        cell.edges.erase(std::remove_if(cell.edges.begin(), cell.edges.end(),
+                                        [this](const EdgeEntry& entry) {
+                                            return entry.version != edgeVersion[entry.id];
+                                        }),
+                         cell.edges.end());
+        cell.staleEdges = 0;
+    }
+}
+
+void PickIndex::queryNodes(float x, float y, std::vector<int>& out) const
+{
+    if (levels.empty()) return;
+
+    uint64_t center = cellOf(x, y);
+    for (int32_t oy = -1; oy <= 1; oy++)
+    {
+        for (int32_t ox = -1; ox <= 1; ox++)
+        {
+            auto it = levels[0].find(pack(unpackX(center) + ox, unpackY(center) + oy));
+            if (it == levels[0].end()) continue;
+            out.insert(out.end(), it->second.nodes.begin(), it->second.nodes.end());
+        }
+    }
+}
+
+auto PickIndex::queryEdges(float x, float y, std::vector<int>& out, size_t limit) const -> bool
+{
+    uint64_t center = cellOf(x, y);
+    for (size_t level = 0; level < levels.size(); level++)
+    {
+        uint64_t cell = coarsen(center, level);
+        for (int32_t oy = -1; oy <= 1; oy++)
+        {
+            for (int32_t ox = -1; ox <= 1; ox++)
+            {
+                auto it = levels[level].find(pack(unpackX(cell) + ox, unpackY(cell) + oy));
+                if (it == levels[level].end()) continue;
+                if (out.size() + it->second.edges.size() > limit) return false;
+                for (const EdgeEntry& entry : it->second.edges)
+                {
+                    if (entry.version == edgeVersion[entry.id]) out.push_back(entry.id);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// узел хеш-таблицы: значение, указатель на следующий и сохранённый хеш
+auto PickIndex::memoryBytes() const -> size_t
+{
+    size_t bytes = vectorBytes(levels) + vectorBytes(nodeCell) + vectorBytes(nodeEdges) +
+                   vectorBytes(edgeEnds) + vectorBytes(edgeVersion) + vectorBytes(scratch);
+    for (const auto& level : levels)
+    {
+        bytes += level.bucket_count() * sizeof(void*);
+        for (const auto& [key, cell] : level)
+        {
+            bytes += sizeof(key) + sizeof(cell) + sizeof(void*) + sizeof(size_t);
+            bytes += vectorBytes(cell.nodes) + vectorBytes(cell.edges);
+        }
+    }
+    return bytes;
+}
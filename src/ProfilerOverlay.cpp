@@ -0,0 +1,51 @@
+#include "ProfilerOverlay.hpp"
+#include <cstdio>
+
+constexpr unsigned OVERLAY_TEXT_SIZE = 14;
+constexpr float ROW_HEIGHT = 18.F;
+constexpr float NAME_WIDTH = 110.F;
+constexpr float COLUMN_WIDTH = 64.F;
+constexpr float PADDING = 8.F;
+// под кнопкой Clear
+constexpr float OVERLAY_X = 10.F;
+constexpr float OVERLAY_Y = 60.F;
+
+void ProfilerOverlay::draw(sf::RenderTarget& target, const sf::Font& font,
+                           const FrameProfiler& profiler)
+{
+    constexpr int COLUMNS = 5;
+    background.setPosition(OVERLAY_X, OVERLAY_Y);
+    background.setSize({2 * PADDING + NAME_WIDTH + (COLUMNS - 1) * COLUMN_WIDTH,
+                        2 * PADDING + (PHASE_COUNT + 1) * ROW_HEIGHT});
+    background.setFillColor(sf::Color(0, 0, 0, 180));
+    target.draw(background);
+
+    text.setFont(font);
+    text.setCharacterSize(OVERLAY_TEXT_SIZE);
+    auto cell = [&](size_t row, int column, const char* value, sf::Color color) {
+        float x = OVERLAY_X + PADDING;
+        if (column > 0) x += NAME_WIDTH + (float) (column - 1) * COLUMN_WIDTH;
+        text.setPosition(x, OVERLAY_Y + PADDING + (float) row * ROW_HEIGHT);
+        text.setString(value);
+        text.setFillColor(color);
+        target.draw(text);
+    };
+
+    const char* header[COLUMNS] = {"ms", "p50", "p95", "p99", "max"};
+    for (int column = 0; column < COLUMNS; column++)
+        cell(0, column, header[column], sf::Color(160, 160, 160));
+
+    char value[32];
+    for (size_t p = 0; p < PHASE_COUNT; p++)
+    {
+        FrameProfiler::Stats stats = profiler.stats((Phase) p);
+        cell(p + 1, 0, FrameProfiler::name((Phase) p), sf::Color::White);
+        if (stats.count == 0) continue;
+        double columns[COLUMNS - 1] = {stats.p50, stats.p95, stats.p99, stats.max};
+        for (int column = 1; column < COLUMNS; column++)
+        {
+            std::snprintf(value, sizeof(value), "%.2f", columns[column - 1]);
+            cell(p + 1, column, value, sf::Color::White);
+        }
+    }
+}
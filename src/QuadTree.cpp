@@ -0,0 +1,90 @@
+#include "QuadTree.hpp"
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+constexpr uint32_t LEAF_CAPACITY = 8;
+
+void QuadTree::build(const std::vector<float>& x, const std::vector<float>& y,
+                     const std::vector<float>* m)
+{
+    xs = &x;
+    ys = &y;
+    masses = m;
+    cells.clear();
+    order.resize(x.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (x.empty()) return;
+
+    auto [minX, maxX] = std::minmax_element(x.begin(), x.end());
+    auto [minY, maxY] = std::minmax_element(y.begin(), y.end());
+    float halfSize = std::max(*maxX - *minX, *maxY - *minY) / 2 + 1.F;
+
+    cells.push_back({(*minX + *maxX) / 2, (*minY + *maxY) / 2, halfSize, 0, 0, 0, -1, 0,
+                     (uint32_t) x.size()});
+    subdivide(0, 0);
+}
+
+void QuadTree::subdivide(int cellId, int depth)
+{
+    auto& x = *xs;
+    auto& y = *ys;
+    Cell cell = cells[cellId];
+
+    if (cell.end - cell.begin <= LEAF_CAPACITY || depth >= MAX_DEPTH)
+    {
+        float sumX = 0, sumY = 0, mass = 0;
+        for (uint32_t k = cell.begin; k < cell.end; k++)
+        {
+            float m = masses ? (*masses)[order[k]] : 1.F;
+            sumX += m * x[order[k]];
+            sumY += m * y[order[k]];
+            mass += m;
+        }
+        cells[cellId].mass = mass;
+        cells[cellId].massX = mass > 0 ? sumX / mass : cell.centerX;
+        cells[cellId].massY = mass > 0 ? sumY / mass : cell.centerY;
+        return;
+    }
+
+    // раскладываем индексы по квадрантам: [лево-верх, право-верх, лево-низ, право-низ]
+    auto first = order.begin() + cell.begin;
+    auto last = order.begin() + cell.end;
+    auto top = [&](int id) { return y[id] < cell.centerY; };
+    auto left = [&](int id) { return x[id] < cell.centerX; };
+    auto splitY = std::partition(first, last, top);
+    auto splitTop = std::partition(first, splitY, left);
+    auto splitBottom = std::partition(splitY, last, left);
+
+    std::array<uint32_t, 5> bounds = {cell.begin, (uint32_t) (splitTop - order.begin()),
+                                      (uint32_t) (splitY - order.begin()),
+                                      (uint32_t) (splitBottom - order.begin()), cell.end};
+
+    int firstChild = (int) cells.size();
+    cells[cellId].firstChild = firstChild;
+    float quarter = cell.halfSize / 2;
+    for (int q = 0; q < 4; q++)
+    {
+        float cx = cell.centerX + ((q & 1) ? quarter : -quarter);
+        float cy = cell.centerY + ((q & 2) ? quarter : -quarter);
+        cells.push_back({cx, cy, quarter, 0, 0, 0, -1, bounds[q], bounds[q + 1]});
+    }
+
+    float mass = 0, sumX = 0, sumY = 0;
+    for (int q = 0; q < 4; q++)
+    {
+        subdivide(firstChild + q, depth + 1);
+        const Cell& child = cells[firstChild + q];
+        mass += child.mass;
+        sumX += child.massX * child.mass;
+        sumY += child.massY * child.mass;
+    }
+    cells[cellId].mass = mass;
+    cells[cellId].massX = sumX / mass;
+    cells[cellId].massY = sumY / mass;
+}
+
+auto QuadTree::memoryBytes() const -> size_t
+{
+    return vectorBytes(cells) + vectorBytes(order);
+}
@@ -0,0 +1,139 @@
+#include "ShortestPath.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+constexpr float UNREACHABLE = std::numeric_limits<float>::infinity();
+// запас на ошибки округления, чтобы оценка A* не превышала настоящий путь
+constexpr float HEURISTIC_SLACK = 1.F - 1e-4F;
+
+void ShortestPath::build(const std::vector<Edge>& edges, size_t nodeCount)
+{
+    start.assign(nodeCount + 1, 0);
+    for (auto& edge : edges)
+    {
+        if (edge.firstNodeId == edge.secondNodeId) continue;
+        start[edge.firstNodeId + 1]++;
+        start[edge.secondNodeId + 1]++;
+    }
+    for (size_t i = 0; i < nodeCount; i++) start[i + 1] += start[i];
+
+    edgeFirst.clear();
+    edgeSecond.clear();
+    edgeWeights.clear();
+    arcs.resize(start.back());
+    std::vector<uint32_t> fill(start.begin(), start.end() - 1);
+    for (size_t e = 0; e < edges.size(); e++)
+    {
+        int a = edges[e].firstNodeId, b = edges[e].secondNodeId;
+        if (a == b) continue;
+        arcs[fill[a]++] = {b, (int) e, edges[e].weight};
+        arcs[fill[b]++] = {a, (int) e, edges[e].weight};
+        edgeFirst.push_back(a);
+        edgeSecond.push_back(b);
+        edgeWeights.push_back(edges[e].weight);
+    }
+
+    labels.assign(nodeCount, {0.F, 0, -1, -1});
+    query = 0;
+    scaleValid = false;
+}
+
+auto ShortestPath::dijkstra(int from, int to, std::vector<int>& path) -> float
+{
+    return search(from, to, nullptr, nullptr, 0.F, path);
+}
+
+// Оценка - расстояние по прямой, умноженное на наименьшее отношение веса
+// ребра к его длине. Так она не превышает остаток пути при любых весах, а
+// пока веса не правили (вес = длина при создании), близка к нему. Проход по
+// рёбрам за масштабом повторяется, только если с прошлого запроса сдвинулись
+// вершины или пересобран граф.
+auto ShortestPath::aStar(int from, int to, const std::vector<float>& xs,
+                         const std::vector<float>& ys, uint64_t positionsVersion,
+                         std::vector<int>& path) -> float
+{
+    if (!scaleValid || scaleVersion != positionsVersion)
+    {
+        float scale2 = UNREACHABLE, minWeight = UNREACHABLE;
+        for (size_t e = 0; e < edgeWeights.size(); e++)
+        {
+            float dx = xs[edgeSecond[e]] - xs[edgeFirst[e]];
+            float dy = ys[edgeSecond[e]] - ys[edgeFirst[e]];
+            float weight = edgeWeights[e];
+            // у ребра нулевой длины отношение бесконечно и в минимум не попадает
+            float ratio = weight * weight / (dx * dx + dy * dy);
+            scale2 = ratio < scale2 ? ratio : scale2;
+            minWeight = weight < minWeight ? weight : minWeight;
+        }
+        bool usable = minWeight > 0.F && scale2 != UNREACHABLE;
+        heuristicScale = usable ? std::sqrt(scale2) * HEURISTIC_SLACK : 0.F;
+        scaleVersion = positionsVersion;
+        scaleValid = true;
+    }
+    if (heuristicScale == 0.F) return dijkstra(from, to, path);
+    return search(from, to, xs.data(), ys.data(), heuristicScale, path);
+}
+
+void ShortestPath::beginQuery()
+{
+    if (++query == 0)
+    {
+        for (Label& label : labels) label.query = 0;
+        query = 1;
+    }
+    heap.clear();
+}
+
+auto ShortestPath::search(int from, int to, const float* xs, const float* ys, float scale,
+                          std::vector<int>& path) -> float
+{
+    path.clear();
+    beginQuery();
+
+    auto later = [](const HeapEntry& a, const HeapEntry& b) {
+        return a.key > b.key || (a.key == b.key && a.distance < b.distance);
+    };
+    auto estimate = [&](int v) {
+        if (xs == nullptr) return 0.F;
+        float dx = xs[to] - xs[v], dy = ys[to] - ys[v];
+        return scale * std::sqrt(dx * dx + dy * dy);
+    };
+
+    labels[from] = {0.F, query, -1, -1};
+    heap.push_back({estimate(from), 0.F, from});
+
+    while (!heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        HeapEntry top = heap.back();
+        heap.pop_back();
+        // устаревшая запись: до вершины уже нашёлся путь короче
+        if (top.distance > labels[top.node].distance) continue;
+        if (top.node == to) break;
+
+        for (uint32_t k = start[top.node]; k < start[top.node + 1]; k++)
+        {
+            const Arc& arc = arcs[k];
+            float candidate = top.distance + arc.weight;
+            Label& label = labels[arc.target];
+            if (label.query == query && candidate >= label.distance) continue;
+
+            label = {candidate, query, top.node, arc.edge};
+            heap.push_back({candidate + estimate(arc.target), candidate, arc.target});
+            std::push_heap(heap.begin(), heap.end(), later);
+        }
+    }
+
+    if (labels[to].query != query) return UNREACHABLE;
+    for (int v = to; v != from; v = labels[v].parent) path.push_back(labels[v].parentEdge);
+    std::reverse(path.begin(), path.end());
+    return labels[to].distance;
+}
+
+auto ShortestPath::memoryBytes() const -> size_t
+{
+    return vectorBytes(start) + vectorBytes(arcs) + vectorBytes(edgeFirst) +
+           vectorBytes(edgeSecond) + vectorBytes(edgeWeights) + vectorBytes(labels) +
+           vectorBytes(heap);
+}
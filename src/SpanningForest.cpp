@@ -0,0 +1,81 @@
+#include "SpanningForest.hpp"
+#include <algorithm>
+
+auto SpanningForest::build(const std::vector<Edge>& edges,
+                           const std::vector<std::vector<int>>& incidentEdges, ThreadPool& pool,
+                           std::vector<int>& forest) -> float
+{
+    size_t n = incidentEdges.size();
+    sets.reset(n);
+    roots.resize(n);
+    nodeBest.resize(n);
+    componentBest.assign(n, -1);
+    forest.clear();
+
+    auto lighter = [&](int e, int than) {
+        return than == -1 || edges[e].weight < edges[than].weight ||
+               (edges[e].weight == edges[than].weight && e < than);
+    };
+
+    start.assign(n + 1, 0);
+    for (size_t i = 0; i < n; i++) start[i + 1] = start[i] + (uint32_t) incidentEdges[i].size();
+    sortedEdges.resize(start[n]);
+    pool.parallelFor(n, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            auto first = sortedEdges.begin() + start[i];
+            std::copy(incidentEdges[i].begin(), incidentEdges[i].end(), first);
+            std::sort(first, first + (long) incidentEdges[i].size(), lighter);
+        }
+    });
+    cursor.assign(start.begin(), start.end() - 1);
+
+    for (bool merged = true; merged;)
+    {
+        merged = false;
+        // корни считаются заранее: find сокращает пути и писать из потоков нельзя
+        for (size_t i = 0; i < n; i++) roots[i] = sets.find((int) i);
+
+        pool.parallelFor(n, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                uint32_t k = cursor[i];
+                while (k < start[i + 1] && roots[edges[sortedEdges[k]].firstNodeId] ==
+                                               roots[edges[sortedEdges[k]].secondNodeId])
+                    k++;
+                cursor[i] = k;
+                nodeBest[i] = k < start[i + 1] ? sortedEdges[k] : -1;
+            }
+        });
+
+        for (size_t i = 0; i < n; i++)
+        {
+            int e = nodeBest[i];
+            if (e != -1 && lighter(e, componentBest[roots[i]])) componentBest[roots[i]] = e;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            int e = componentBest[i];
+            if (e == -1) continue;
+            componentBest[i] = -1;
+            // обе компоненты могли выбрать одно и то же ребро
+            if (sets.unite(edges[e].firstNodeId, edges[e].secondNodeId))
+            {
+                forest.push_back(e);
+                merged = true;
+            }
+        }
+    }
+
+    std::sort(forest.begin(), forest.end());
+    double total = 0;
+    for (int e : forest) total += edges[e].weight;
+    return (float) total;
+}
+
+auto SpanningForest::memoryBytes() const -> size_t
+{
+    return vectorBytes(start) + vectorBytes(sortedEdges) + vectorBytes(cursor) +
+           vectorBytes(roots) + vectorBytes(nodeBest) + vectorBytes(componentBest) +
+           sets.memoryBytes();
+}
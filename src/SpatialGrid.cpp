@@ -0,0 +1,66 @@
+#include "SpatialGrid.hpp"
+#include <cmath>
+
+void SpatialGrid::build(const std::vector<float>& xs, const std::vector<float>& ys, float size)
+{
+    cellSize = size;
+
+    uint32_t bucketCount = 1;
+    while (bucketCount < 2 * xs.size()) bucketCount <<= 1;
+    mask = bucketCount - 1;
+
+    bucketStart.assign(bucketCount + 1, 0);
+    itemBucket.resize(xs.size());
+    items.resize(xs.size());
+
+    for (size_t i = 0; i < xs.size(); i++)
+    {
+        itemBucket[i] = bucketOf(cellOf(xs[i]), cellOf(ys[i]));
+        bucketStart[itemBucket[i] + 1]++;
+    }
+    for (uint32_t b = 0; b < bucketCount; b++) bucketStart[b + 1] += bucketStart[b];
+
+    // индексы внутри корзины остаются по возрастанию
+    std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < xs.size(); i++) items[fill[itemBucket[i]]++] = (int) i;
+}
+
+void SpatialGrid::query(float x, float y, std::vector<int>& out) const
+{
+    if (items.empty()) return;
+
+    int32_t cx = cellOf(x);
+    int32_t cy = cellOf(y);
+    uint32_t visited[9];
+    int visitedCount = 0;
+
+    for (int32_t dy = -1; dy <= 1; dy++)
+    {
+        for (int32_t dx = -1; dx <= 1; dx++)
+        {
+            uint32_t bucket = bucketOf(cx + dx, cy + dy);
+            bool seen = false;
+            for (int k = 0; k < visitedCount; k++) seen = seen || visited[k] == bucket;
+            if (seen) continue;
+            visited[visitedCount++] = bucket;
+
+            for (uint32_t k = bucketStart[bucket]; k < bucketStart[bucket + 1]; k++)
+                out.push_back(items[k]);
+        }
+    }
+}
+
+auto SpatialGrid::cellOf(float coord) const -> int32_t
+{
+    return (int32_t) std::floor(coord / cellSize);
+}
+
+auto SpatialGrid::bucketOf(int32_t cx, int32_t cy) const -> uint32_t
+{
+    return (((uint32_t) cx * 73856093U) ^ ((uint32_t) cy * 19349663U)) & mask;
+}
+
+auto SpatialGrid::memoryBytes() const -> size_t
+{
+    return vectorBytes(bucketStart) + vectorBytes(items) + vectorBytes(itemBucket);
+}
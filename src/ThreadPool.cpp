@@ -0,0 +1,76 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+constexpr size_t MIN_CHUNK = 256;
+constexpr size_t CHUNKS_PER_THREAD = 8;
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    for (unsigned i = 1; i < threadCount; i++) workers.emplace_back([this] { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::parallelFor(size_t count, const Body& body)
+{
+    if (count == 0) return;
+    if (workers.empty() || count <= MIN_CHUNK)
+    {
+        body(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &body;
+        jobCount = count;
+        chunkSize = std::max(MIN_CHUNK, count / (size() * CHUNKS_PER_THREAD));
+        nextIndex = 0;
+        pending = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::runChunks()
+{
+    for (;;)
+    {
+        size_t begin = nextIndex.fetch_add(chunkSize);
+        if (begin >= jobCount) return;
+        (*job)(begin, std::min(begin + chunkSize, jobCount));
+    }
+}
+
+void ThreadPool::workerLoop()
+{
+    unsigned seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        runChunks();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) done.notify_one();
+    }
+}
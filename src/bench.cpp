@@ -0,0 +1,525 @@
+#include "GraphCore.hpp"
+#ifndef GRAPH_BENCH_NO_RENDER
+#include "Graph.hpp"
+#endif
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Замеры горячих путей на синтетических графах без окна. Результат - JSON
+// в stdout, ход работы - в stderr.
+//
+//   bench [--max-nodes N] [--threads N] [--seconds S] [--font path.ttf]
+//
+// Перед замерами векторные ядра сил сверяются со скалярными; при
+// расхождении код выхода 1. --max-nodes 0 - только сверка (make check).
+
+namespace
+{
+constexpr float NODE_SPACING = 40.F;
+constexpr int GROWTH_STEPS = 40;
+constexpr int PICK_QUERIES = 10000;
+constexpr int EDGE_QUERIES = 100000;
+constexpr int PATH_QUERIES = 100;
+constexpr size_t MAX_DRAW_NODES = 100000;
+// кадров без движения, после которых вершины уже не считаются движущимися
+constexpr int SETTLE_FRAMES = 100;
+// длины массивов для сверки ядер: пусто, хвосты короче и длиннее дорожки
+constexpr size_t KERNEL_CHECK_SIZES[] = {0, 1, 7, 8, 9, 17, 1000};
+constexpr float KERNEL_CHECK_STRENGTH = 0.1F;
+
+struct SyntheticGraph
+{
+    std::string kind;
+    std::vector<float> x, y;
+    std::vector<std::pair<int, int>> edges;
+};
+
+struct Options
+{
+    size_t maxNodes = 1000000;
+    unsigned threads = std::max(1U, std::thread::hardware_concurrency());
+    double seconds = 0.5;
+    std::string font;
+};
+
+struct Result
+{
+    std::string name, variant, graph;
+    size_t nodes = 0, edges = 0;
+    int iterations = 0;
+    double meanMs = 0, minMs = 0, maxMs = 0;
+};
+
+std::vector<Result> results;
+
+struct Memory
+{
+    std::string graph;
+    MemoryStats stats;
+};
+
+std::vector<Memory> memory;
+
+void scatter(SyntheticGraph& g, size_t n, std::mt19937& rng)
+{
+    float side = std::sqrt((float) n) * NODE_SPACING;
+    std::uniform_real_distribution<float> coord(0, side);
+    g.x.resize(n);
+    g.y.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        g.x[i] = coord(rng);
+        g.y[i] = coord(rng);
+    }
+}
+
+auto makeRandom(size_t n, std::mt19937& rng) -> SyntheticGraph
+{
+    SyntheticGraph g{"random", {}, {}, {}};
+    scatter(g, n, rng);
+    std::uniform_int_distribution<int> node(0, (int) n - 1);
+    for (size_t e = 0; e < 2 * n; e++) g.edges.emplace_back(node(rng), node(rng));
+    return g;
+}
+
+auto makeGrid(size_t n) -> SyntheticGraph
+{
+    SyntheticGraph g{"grid", {}, {}, {}};
+    auto side = (size_t) std::ceil(std::sqrt((double) n));
+    for (size_t i = 0; i < n; i++)
+    {
+        g.x.push_back((float) (i % side) * NODE_SPACING);
+        g.y.push_back((float) (i / side) * NODE_SPACING);
+        if (i % side != 0) g.edges.emplace_back((int) i - 1, (int) i);
+        if (i >= side) g.edges.emplace_back((int) (i - side), (int) i);
+    }
+    return g;
+}
+
+// Барабаши-Альберт: каждая новая вершина цепляется к двум существующим,
+// выбранным пропорционально степени
+auto makeScaleFree(size_t n, std::mt19937& rng) -> SyntheticGraph
+{
+    SyntheticGraph g{"scale-free", {}, {}, {}};
+    scatter(g, n, rng);
+    std::vector<int> ends = {0, 1};
+    g.edges.emplace_back(0, 1);
+    for (size_t i = 2; i < n; i++)
+    {
+        for (int k = 0; k < 2; k++)
+        {
+            int target = ends[std::uniform_int_distribution<size_t>(0, ends.size() - 1)(rng)];
+            g.edges.emplace_back((int) i, target);
+            ends.push_back(target);
+            ends.push_back((int) i);
+        }
+    }
+    return g;
+}
+
+void load(const SyntheticGraph& g, GraphCore& core)
+{
+    core.addNodes(g.x.data(), g.y.data(), g.x.size());
+    core.addEdges(g.edges.data(), g.edges.size());
+}
+
+template <typename Setup, typename Run>
+void measure(const Options& options, const std::string& name, const std::string& variant,
+             const SyntheticGraph& g, Setup&& setup, Run&& run)
+{
+    using Clock = std::chrono::steady_clock;
+    Result r{name, variant, g.kind, g.x.size(), g.edges.size(), 0, 0, 1e300, 0};
+    double total = 0;
+    while (r.iterations == 0 || total < options.seconds * 1000)
+    {
+        setup();
+        auto start = Clock::now();
+        run();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        total += ms;
+        r.minMs = std::min(r.minMs, ms);
+        r.maxMs = std::max(r.maxMs, ms);
+        r.iterations++;
+    }
+    r.meanMs = total / r.iterations;
+    std::fprintf(stderr, "  %-14s %-10s %-10s %8zu nodes  %10.3f ms\n", name.c_str(),
+                 variant.c_str(), g.kind.c_str(), r.nodes, r.meanMs);
+    results.push_back(r);
+}
+
+void benchPhysics(const Options& options, const SyntheticGraph& g)
+{
+    GraphCore core;
+    load(g, core);
+    for (int i = 0; i < GROWTH_STEPS; i++) core.growNodes();
+    // меряем полный шаг: уснувший граф шагал бы за время одной проверки
+    core.sleeping = false;
+
+    struct Variant
+    {
+        const char* name;
+        LayoutMode mode;
+        bool parallel;
+    };
+    for (auto variant : {Variant{"overlap", LayoutMode::Overlap, false},
+                         Variant{"overlap-mt", LayoutMode::Overlap, true},
+                         Variant{"barnes-hut", LayoutMode::BarnesHut, false},
+                         Variant{"barnes-hut-mt", LayoutMode::BarnesHut, true}})
+    {
+        core.layoutMode = variant.mode;
+        core.parallelStep = variant.parallel;
+        core.threadCount = options.threads;
+        measure(options, "updatePhysics", variant.name, g, [] {}, [&] { core.step(-1); });
+    }
+
+    // остальные модели сил - на самом нагруженном варианте
+    core.layoutMode = LayoutMode::BarnesHut;
+    core.parallelStep = true;
+    for (const auto& model : GraphCore::forceModels())
+    {
+        if (&model == &GraphCore::forceModels()[0]) continue;
+        core.setForceModel(model.name);
+        core.sleeping = false;
+        measure(options, "updatePhysics", std::string("barnes-hut-mt ") + model.name, g, [] {},
+                [&] { core.step(-1); });
+    }
+}
+
+void benchEdges(const Options& options, const SyntheticGraph& g)
+{
+    GraphCore core;
+    measure(
+        options, "addEdge", "", g,
+        [&] {
+            core = GraphCore();
+            for (size_t i = 0; i < g.x.size(); i++) core.addNode(g.x[i], g.y[i]);
+        },
+        [&] {
+            for (auto& [a, b] : g.edges) core.addEdge(a, b);
+        });
+    measure(
+        options, "addEdges", "bulk", g,
+        [&] {
+            core = GraphCore();
+            core.addNodes(g.x.data(), g.y.data(), g.x.size());
+        },
+        [&] { core.addEdges(g.edges.data(), g.edges.size()); });
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> pick(0, g.edges.size() - 1);
+    std::uniform_int_distribution<int> node(0, (int) g.x.size() - 1);
+    std::vector<std::pair<int, int>> queries;
+    for (int q = 0; q < EDGE_QUERIES; q++)
+    {
+        queries.push_back(q % 2 ? g.edges[pick(rng)] : std::make_pair(node(rng), node(rng)));
+    }
+    size_t found = 0;
+    measure(
+        options, "hasEdge", "100k queries", g, [] {},
+        [&] {
+            for (auto& [a, b] : queries) found += core.hasEdge(a, b);
+        });
+    if (found == 0) std::fprintf(stderr, "  hasEdge: no hits\n");
+}
+
+void benchPicking(const Options& options, const SyntheticGraph& g)
+{
+    GraphCore core;
+    load(g, core);
+    for (int i = 0; i < GROWTH_STEPS; i++) core.growNodes();
+
+    float side = std::sqrt((float) g.x.size()) * NODE_SPACING;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> coord(0, side);
+    std::vector<std::pair<float, float>> points(PICK_QUERIES);
+    for (auto& p : points) p = {coord(rng), coord(rng)};
+
+    int hits = 0;
+    measure(
+        options, "pickNode", "10k queries", g, [] {},
+        [&] {
+            for (auto& [x, y] : points) hits += core.pickNode(x, y) != -1;
+        });
+    measure(
+        options, "pickEdge", "10k queries", g, [] {},
+        [&] {
+            for (auto& [x, y] : points) hits += core.pickEdge(x, y, 10.F) != -1;
+        });
+    if (hits < 0) std::fprintf(stderr, "unreachable\n");
+}
+
+void benchPaths(const Options& options, const SyntheticGraph& g)
+{
+    GraphCore core;
+    load(g, core);
+
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<int> node(0, (int) g.x.size() - 1);
+    std::vector<std::pair<int, int>> queries(PATH_QUERIES);
+    for (auto& q : queries) q = {node(rng), node(rng)};
+
+    std::vector<int> path;
+    core.shortestPath(0, 0, path);  // индекс строится при первом запросе, не в замере
+    for (bool useAStar : {false, true})
+    {
+        measure(
+            options, "shortestPath", useAStar ? "100 a-star" : "100 dijkstra", g, [] {},
+            [&] {
+                for (auto& [a, b] : queries) core.shortestPath(a, b, path, useAStar);
+            });
+    }
+}
+
+void benchLayout(const Options& options, const SyntheticGraph& g)
+{
+    GraphCore core;
+    load(g, core);
+    core.threadCount = options.threads;
+    measure(
+        options, "layoutMultilevel", "", g,
+        [&] {
+            core.posX = g.x;
+            core.posY = g.y;
+        },
+        [&] { core.layoutMultilevel(); });
+}
+
+void benchSpanning(const Options& options, const SyntheticGraph& g)
+{
+    GraphCore core;
+    load(g, core);
+    core.threadCount = options.threads;
+
+    std::vector<int> forest;
+    measure(options, "spanningForest", "", g, [] {}, [&] { core.minimumSpanningForest(forest); });
+
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> node(0, (int) g.x.size() - 1);
+    std::vector<std::pair<int, int>> queries(EDGE_QUERIES);
+    for (auto& q : queries) q = {node(rng), node(rng)};
+    size_t joined = 0;
+    measure(
+        options, "connected", "100k queries", g, [] {},
+        [&] {
+            for (auto& [a, b] : queries) joined += core.connected(a, b);
+        });
+    if (joined == 0) std::fprintf(stderr, "  connected: no hits\n");
+}
+
+// после одного шага, когда рабочие буферы физики уже заведены; без SFML
+// только ядро
+void benchMemory(const SyntheticGraph& g)
+{
+#ifndef GRAPH_BENCH_NO_RENDER
+    Graph graph;
+    graph.addNodes(g.x.data(), g.y.data(), g.x.size());
+    graph.addEdges(g.edges.data(), g.edges.size());
+    graph.updatePhysics(-1);
+    graph.updateNodes();
+    MemoryStats stats = graph.memoryStats();
+#else
+    GraphCore core;
+    load(g, core);
+    core.step(-1);
+    MemoryStats stats = core.memoryStats();
+#endif
+    std::fprintf(stderr, "  %-25s %-10s %8zu nodes  %6.1f B/node  %6.1f B/edge  %8.1f MB\n",
+                 "memory", g.kind.c_str(), stats.nodes, stats.bytesPerNode(),
+                 stats.bytesPerEdge(), (double) stats.totalBytes() / (1 << 20));
+    memory.push_back({g.kind, stats});
+}
+
+#ifndef GRAPH_BENCH_NO_RENDER
+void benchDraw(const Options& options, const SyntheticGraph& g, const sf::Font& font)
+{
+    if (g.x.size() > MAX_DRAW_NODES) return;
+
+    sf::RenderTexture target;
+    if (!target.create(1920, 1080))
+    {
+        std::fprintf(stderr, "  draw: no offscreen render target, skipped\n");
+        return;
+    }
+
+    Graph graph;
+    graph.addNodes(g.x.data(), g.y.data(), g.x.size());
+    graph.addEdges(g.edges.data(), g.edges.size());
+    for (int i = 0; i < GROWTH_STEPS; i++) graph.updateNodes();
+
+    measure(
+        options, "draw", "offscreen", g, [&] { target.clear(sf::Color::Black); },
+        [&] {
+            graph.draw(target, font);
+            target.display();
+        });
+
+    // перетаскивание: двигается одна вершина, остальное берётся из кэша
+    // неподвижной части; первый кадр его строит
+    for (int i = 0; i < SETTLE_FRAMES; i++) graph.updateNodes();
+    int dragged = (int) g.x.size() / 2;
+    graph.setDraggedNode(dragged);
+    float offset = 0;
+    measure(
+        options, "draw", "drag", g,
+        [&] {
+            offset = offset > 0 ? -1.F : 1.F;
+            graph.setPosition(dragged, {g.x[dragged] + offset, g.y[dragged]});
+            graph.updateNodes();
+            target.clear(sf::Color::Black);
+        },
+        [&] {
+            graph.draw(target, font);
+            target.display();
+        });
+}
+#endif
+
+auto sameBits(const std::vector<float>& a, const std::vector<float>& b) -> bool
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+// Векторные ядра против скалярных: результаты должны совпасть побитово.
+// Соседи разбросаны вокруг вершины так, что часть пересекается, один лежит
+// точно в ней; у первой пружины концы совпадают. Расхождения - в stderr.
+auto checkKernels() -> bool
+{
+    const ForceKernels& vector = forceKernels();
+    const ForceKernels& scalar = scalarForceKernels();
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> offset(-2 * NODE_RADIUS_MAX, 2 * NODE_RADIUS_MAX);
+    std::uniform_real_distribution<float> size(1.F, NODE_RADIUS_MAX);
+    bool ok = true;
+    for (size_t n : KERNEL_CHECK_SIZES)
+    {
+        float x = 100.F, y = 50.F, r = NODE_RADIUS_MAX;
+        std::vector<float> xs(n), ys(n), rs(n);
+        for (size_t k = 0; k < n; k++)
+        {
+            xs[k] = k == 0 ? x : x + offset(rng);
+            ys[k] = k == 0 ? y : y + offset(rng);
+            rs[k] = size(rng);
+        }
+        std::vector<float> pushX(n), pushY(n), expectX(n), expectY(n);
+        vector.overlap(x, y, r, xs.data(), ys.data(), rs.data(), pushX.data(), pushY.data(), n,
+                       KERNEL_CHECK_STRENGTH);
+        scalar.overlap(x, y, r, xs.data(), ys.data(), rs.data(), expectX.data(), expectY.data(),
+                       n, KERNEL_CHECK_STRENGTH);
+        if (!sameBits(pushX, expectX) || !sameBits(pushY, expectY))
+        {
+            std::fprintf(stderr, "%s overlap differs from scalar, n = %zu\n", vector.name, n);
+            ok = false;
+        }
+
+        std::vector<float> bx(n), by(n), rest(n);
+        for (size_t k = 0; k < n; k++)
+        {
+            bx[k] = k == 0 ? xs[k] : xs[k] + offset(rng);
+            by[k] = k == 0 ? ys[k] : ys[k] + offset(rng);
+            rest[k] = size(rng) * 4;
+        }
+        vector.springs(xs.data(), ys.data(), bx.data(), by.data(), rest.data(), pushX.data(),
+                       pushY.data(), n, KERNEL_CHECK_STRENGTH);
+        scalar.springs(xs.data(), ys.data(), bx.data(), by.data(), rest.data(), expectX.data(),
+                       expectY.data(), n, KERNEL_CHECK_STRENGTH);
+        if (!sameBits(pushX, expectX) || !sameBits(pushY, expectY))
+        {
+            std::fprintf(stderr, "%s springs differ from scalar, n = %zu\n", vector.name, n);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+void printJson(const Options& options)
+{
+    std::printf("{\n  \"kernels\": \"%s\",\n  \"threads\": %u,\n  \"benchmarks\": [\n",
+                forceKernels().name, options.threads);
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        std::printf("    {\"name\": \"%s\", \"variant\": \"%s\", \"graph\": \"%s\", "
+                    "\"nodes\": %zu, \"edges\": %zu, \"iterations\": %d, "
+                    "\"mean_ms\": %.6f, \"min_ms\": %.6f, \"max_ms\": %.6f}%s\n",
+                    r.name.c_str(), r.variant.c_str(), r.graph.c_str(), r.nodes, r.edges,
+                    r.iterations, r.meanMs, r.minMs, r.maxMs,
+                    i + 1 < results.size() ? "," : "");
+    }
+    std::printf("  ],\n  \"memory\": [\n");
+    for (size_t i = 0; i < memory.size(); i++)
+    {
+        const MemoryStats& s = memory[i].stats;
+        std::printf("    {\"graph\": \"%s\", \"nodes\": %zu, \"edges\": %zu, "
+                    "\"node_bytes\": %zu, \"edge_bytes\": %zu, \"index_bytes\": %zu, "
+                    "\"scratch_bytes\": %zu, \"bytes_per_node\": %.1f, "
+                    "\"bytes_per_edge\": %.1f}%s\n",
+                    memory[i].graph.c_str(), s.nodes, s.edges, s.nodeBytes, s.edgeBytes,
+                    s.indexBytes, s.scratchBytes, s.bytesPerNode(), s.bytesPerEdge(),
+                    i + 1 < memory.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--max-nodes") == 0)
+        {
+            options.maxNodes = std::strtoul(argv[i + 1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0)
+        {
+            options.threads = (unsigned) std::atoi(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--seconds") == 0)
+        {
+            options.seconds = std::atof(argv[i + 1]);
+        }
+        else if (std::strcmp(argv[i], "--font") == 0)
+        {
+            options.font = argv[i + 1];
+        }
+    }
+    options.threads = std::max(1U, options.threads);
+
+    if (!checkKernels()) return 1;
+
+#ifndef GRAPH_BENCH_NO_RENDER
+    sf::Font font;
+    bool haveFont = !options.font.empty() && font.loadFromFile(options.font);
+    if (!haveFont) std::fprintf(stderr, "no --font given, draw benchmark skipped\n");
+#endif
+
+    std::mt19937 rng(42);
+    for (size_t n = 1000; n <= options.maxNodes; n *= 10)
+    {
+        for (auto& g : {makeRandom(n, rng), makeGrid(n), makeScaleFree(n, rng)})
+        {
+            benchPhysics(options, g);
+            benchEdges(options, g);
+            benchPicking(options, g);
+            benchPaths(options, g);
+            benchSpanning(options, g);
+            benchLayout(options, g);
+            benchMemory(g);
+#ifndef GRAPH_BENCH_NO_RENDER
+            if (haveFont) benchDraw(options, g, font);
+#endif
+        }
+    }
+
+    printJson(options);
+    return 0;
+}
@@ -0,0 +1,315 @@
+#include "GraphCore.hpp"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Раскладка без окна: читает графы в двоичном формате (GraphFile.hpp), гоняет
+// те же шаги физики, что и редактор, и пишет граф с новыми позициями рядом:
+// a.bin -> a.layout.bin. Файл не в двоичном формате читается как текстовый
+// граф (EdgeListImport.hpp), результат всё равно двоичный: a.txt -> a.layout.bin.
+// Несколько графов раскладываются параллельно, по одному на задачу. Итоги -
+// JSON в stdout, ход работы - в stderr.
+//
+//   graph-layout [--iterations N] [--tolerance E] [--jobs N] [--threads N]
+//                [--barnes-hut] [--multilevel] [--model linear] [--suffix .layout]
+//                a.bin b.bin ...
+
+namespace
+{
+// пока вершины растут, малая энергия ещё не значит, что раскладка сошлась
+constexpr int GROWTH_ITERATIONS = (int) (NODE_RADIUS_MAX / NODE_GROWTH_SPEED);
+// верхняя граница --jobs и --threads
+constexpr unsigned MAX_THREADS = 1024;
+
+struct Options
+{
+    int iterations = 1000;
+    // средний квадрат сдвига вершины за шаг, ниже которого раскладка сошлась
+    float tolerance = 1e-4F;
+    unsigned jobs = std::max(1U, std::thread::hardware_concurrency());
+    unsigned threads = 1;
+    bool barnesHut = false;
+    bool multilevel = false;
+    std::string model = GraphCore::forceModels()[0].name;
+    std::string suffix = ".layout";
+    std::vector<std::string> files;
+};
+
+struct Result
+{
+    std::string input, output;
+    bool ok = false;
+    size_t nodes = 0, edges = 0;
+    int iterations = 0;
+    bool converged = false;
+    double ms = 0;
+    std::string error;
+};
+
+// extension пустое - как у входного файла
+auto outputPath(const std::string& input, const std::string& suffix, const std::string& extension)
+    -> std::string
+{
+    size_t slash = input.find_last_of('/');
+    size_t dot = input.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return input + suffix + extension;
+    return input.substr(0, dot) + suffix + (extension.empty() ? input.substr(dot) : extension);
+}
+
+auto layoutFile(const Options& options, const std::string& input) -> Result
+{
+    using Clock = std::chrono::steady_clock;
+    Result r;
+    r.input = input;
+    r.output = outputPath(input, options.suffix, "");
+
+    GraphCore core;
+    if (!core.load(input))
+    {
+        ImportedGraph imported;
+        if (!importEdgeList(input, imported, options.threads))
+        {
+            r.error = imported.error;
+            r.output.clear();
+            return r;
+        }
+        core.importGraph(imported);
+        r.output = outputPath(input, options.suffix, ".bin");
+    }
+    r.nodes = core.nodeCount();
+    r.edges = core.edges.size();
+    core.layoutMode = options.barnesHut ? LayoutMode::BarnesHut : LayoutMode::Overlap;
+    core.threadCount = options.threads;
+    core.parallelStep = options.threads > 1;
+    core.setForceModel(options.model);
+
+    auto start = Clock::now();
+    if (options.multilevel) core.layoutMultilevel();
+    while (r.iterations < options.iterations)
+    {
+        core.step(-1);
+        core.growNodes();
+        core.clearChanged();
+        r.iterations++;
+        float meanEnergy = core.energy() / (float) std::max<size_t>(1, r.nodes);
+        if (r.iterations >= GROWTH_ITERATIONS &&
+            (core.awakeCount() == 0 || meanEnergy < options.tolerance))
+        {
+            r.converged = true;
+            break;
+        }
+    }
+    r.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    r.ok = core.save(r.output);
+    if (!r.ok) r.error = "cannot write " + r.output;
+    return r;
+}
+
+// число потоков или задач: целое от 1 до MAX_THREADS без лишних символов
+auto parseCount(const char* text, unsigned& value) -> bool
+{
+    const char* end = text + std::strlen(text);
+    unsigned parsed = 0;
+    auto [last, ec] = std::from_chars(text, end, parsed);
+    if (ec != std::errc() || last != end || parsed == 0 || parsed > MAX_THREADS) return false;
+    value = parsed;
+    return true;
+}
+
+// число итераций: целое больше нуля без лишних символов
+auto parseIterations(const char* text, int& value) -> bool
+{
+    const char* end = text + std::strlen(text);
+    int parsed = 0;
+    auto [last, ec] = std::from_chars(text, end, parsed);
+    if (ec != std::errc() || last != end || parsed <= 0) return false;
+    value = parsed;
+    return true;
+}
+
+// порог сходимости: конечное число больше нуля
+auto parseTolerance(const char* text, float& value) -> bool
+{
+    const char* end = text + std::strlen(text);
+    float parsed = 0;
+    auto [last, ec] = std::from_chars(text, end, parsed);
+    if (ec != std::errc() || last != end || !std::isfinite(parsed) || parsed <= 0) return false;
+    value = parsed;
+    return true;
+}
+
+// строка для JSON в кавычках: пути могут содержать кавычки, \ и управляющие символы
+auto jsonString(const std::string& text) -> std::string
+{
+    std::string quoted = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if ((unsigned char) c < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned) c);
+            quoted += escaped;
+        }
+        else
+        {
+            quoted += c;
+        }
+    }
+    return quoted + '"';
+}
+
+void printJson(const Options& options, const std::vector<Result>& results, double totalMs)
+{
+    std::printf("{\n  \"jobs\": %u,\n  \"threads\": %u,\n  \"model\": \"%s\",\n  "
+                "\"total_ms\": %.3f,\n  \"graphs\": [\n",
+                options.jobs, options.threads, options.model.c_str(), totalMs);
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& r = results[i];
+        double seconds = r.ms / 1000;
+        std::printf("    {\"input\": %s, \"output\": %s, \"ok\": %s, \"nodes\": %zu, "
+                    "\"edges\": %zu, \"iterations\": %d, \"converged\": %s, \"ms\": %.3f, "
+                    "\"steps_per_s\": %.1f, \"node_steps_per_s\": %.0f}%s\n",
+                    jsonString(r.input).c_str(), jsonString(r.output).c_str(),
+                    r.ok ? "true" : "false", r.nodes, r.edges, r.iterations,
+                    r.converged ? "true" : "false", r.ms,
+                    seconds > 0 ? r.iterations / seconds : 0,
+                    seconds > 0 ? (double) r.nodes * r.iterations / seconds : 0,
+                    i + 1 < results.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+}
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--barnes-hut") == 0)
+        {
+            options.barnesHut = true;
+        }
+        else if (std::strcmp(argv[i], "--multilevel") == 0)
+        {
+            options.multilevel = true;
+        }
+        else if (std::strcmp(argv[i], "--iterations") == 0 && hasValue)
+        {
+            if (!parseIterations(argv[++i], options.iterations))
+            {
+                std::fprintf(stderr, "--iterations expects a positive integer, got %s\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--tolerance") == 0 && hasValue)
+        {
+            if (!parseTolerance(argv[++i], options.tolerance))
+            {
+                std::fprintf(stderr, "--tolerance expects a positive number, got %s\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--jobs") == 0 && hasValue)
+        {
+            if (!parseCount(argv[++i], options.jobs))
+            {
+                std::fprintf(stderr, "--jobs expects 1..%u, got %s\n", MAX_THREADS, argv[i]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+        {
+            if (!parseCount(argv[++i], options.threads))
+            {
+                std::fprintf(stderr, "--threads expects 1..%u, got %s\n", MAX_THREADS, argv[i]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--model") == 0 && hasValue)
+        {
+            options.model = argv[++i];
+            const auto& models = GraphCore::forceModels();
+            if (std::none_of(models.begin(), models.end(),
+                             [&](const auto& model) { return options.model == model.name; }))
+            {
+                std::fprintf(stderr, "unknown model %s; known:", argv[i]);
+                for (const auto& model : models) std::fprintf(stderr, " %s", model.name);
+                std::fprintf(stderr, "\n");
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--suffix") == 0 && hasValue)
+        {
+            options.suffix = argv[++i];
+        }
+        else if (std::strncmp(argv[i], "--", 2) == 0)
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+        else
+        {
+            options.files.emplace_back(argv[i]);
+        }
+    }
+    if (options.files.empty())
+    {
+        std::fprintf(stderr, "usage: graph-layout [--iterations N] [--tolerance E] [--jobs N] "
+                             "[--threads N] [--barnes-hut] [--multilevel] [--model M] "
+                             "[--suffix S] graph.bin|edges.txt...\n");
+        return 2;
+    }
+    options.jobs = std::min(options.jobs, (unsigned) options.files.size());
+
+    // задачи разбирают файлы по очереди; большой граф не держит остальные
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Result> results(options.files.size());
+    std::atomic<size_t> next{0};
+    std::mutex logMutex;
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < options.jobs; w++)
+    {
+        workers.emplace_back([&] {
+            for (size_t k; (k = next.fetch_add(1)) < options.files.size();)
+            {
+                Result r = layoutFile(options, options.files[k]);
+                std::lock_guard<std::mutex> lock(logMutex);
+                if (r.ok)
+                {
+                    std::fprintf(stderr, "  %-30s %8zu nodes %5d steps%s %10.3f ms\n",
+                                 r.input.c_str(), r.nodes, r.iterations,
+                                 r.converged ? " (converged)" : "", r.ms);
+                }
+                else
+                {
+                    std::fprintf(stderr, "  %-30s %s\n", r.input.c_str(), r.error.c_str());
+                }
+                results[k] = std::move(r);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    double totalMs =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count();
+
+    printJson(options, results, totalMs);
+    bool ok = std::all_of(results.begin(), results.end(), [](const Result& r) { return r.ok; });
+    return ok ? 0 : 1;
+}
@@ -1,10 +1,29 @@
 #include "Graph.hpp"
+#include "ProfilerOverlay.hpp"
 #include "utils.hpp"
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <iterator>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
-int main()
+// масштаб камеры - единиц мира на пиксель окна
+constexpr float MIN_ZOOM = 0.1F;
+constexpr float MAX_ZOOM = 100.F;
+constexpr float ZOOM_STEP = 1.1F;
+constexpr float EDGE_PICK_PIXELS = 10.F;
+// шрифт берётся первый найденный: macOS, Linux, Windows
+constexpr const char* FONT_PATHS[] = {"/System/Library/Fonts/Supplemental/Arial.ttf",
+                                      "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+                                      "C:/Windows/Fonts/arial.ttf"};
+
+// graph [edges.txt]: текстовый граф (EdgeListImport.hpp) разбирается в фоне,
+// окно тем временем работает и показывает ход; граф подменяется по готовности
+int main(int argc, char** argv)
 {
     sf::ContextSettings settings;
     settings.antialiasingLevel = 8;
@@ -13,12 +32,21 @@ int main()
     window.setFramerateLimit(90);
 
     sf::Font font;
-    if (!font.loadFromFile("/System/Library/Fonts/Supplemental/Arial.ttf")) return -1;
+    if (std::none_of(std::begin(FONT_PATHS), std::end(FONT_PATHS),
+                     [&](const char* path) { return font.loadFromFile(path); }))
+        return -1;
 
+    // замеры фаз кадра: P - включить с таблицей на экране, T - записать trace.json
+    FrameProfiler profiler;
+    ProfilerOverlay profilerOverlay;
     Graph graph;
-    int draggedNodeId = -1;
-    int selectedNodeId = -1;
-    int selectedEdgeId = -1;
+    PhysicsThread physics(graph.core, PhysicsThread::DEFAULT_STEP_SECONDS, &profiler);
+    // ссылки, а не номера: номера меняются при удалении
+    NodeHandle draggedNode;
+    NodeHandle selectedNode;
+    EdgeHandle selectedEdge;
+    NodeHandle pathStart;
+    std::vector<int> path;
     bool typingWeight = false;
     std::string weightInput;
 
@@ -30,25 +58,100 @@ int main()
     btnText.setFillColor(sf::Color::White);
     btnText.setPosition(25, 18);
 
+    ImportProgress importProgress;
+    ImportedGraph imported;
+    bool importOk = false;
+    std::thread importer;
+    if (argc > 1)
+    {
+        importer = std::thread([&, path = std::string(argv[1])] {
+            importOk = importEdgeList(path, imported, std::thread::hardware_concurrency(),
+                                      &importProgress);
+        });
+    }
+    // раскладка R считается в своём потоке на снимке графа, как импорт
+    GraphCore::LayoutJob layoutJob;
+    std::atomic<bool> layoutFinished{false};
+    std::thread layouter;
+    sf::Text importText("", font, 18);
+    importText.setFillColor(sf::Color::White);
+    importText.setPosition(130, 18);
+
+    // граф рисуется через камеру, кнопки - в пикселях окна
+    sf::View camera(sf::FloatRect(0, 0, 1920, 1080));
+    sf::View screen = camera;
+    float zoom = 1;
+    bool panning = false;
+    sf::Vector2i panFrom;
+
     while (window.isOpen())
     {
         sf::Event event;
+        FrameProfiler::Scope eventsScope(&profiler, Phase::Events);
         while (window.pollEvent(event))
         {
             if (event.type == sf::Event::Closed) window.close();
 
+            if (event.type == sf::Event::Resized)
+            {
+                sf::Vector2f size((float) event.size.width, (float) event.size.height);
+                screen = sf::View(sf::FloatRect({0, 0}, size));
+                camera.setSize(size * zoom);
+            }
+
+            // колесо - масштаб вокруг курсора, средняя кнопка - сдвиг
+            if (event.type == sf::Event::MouseWheelScrolled &&
+                event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel)
+            {
+                sf::Vector2i pixel(event.mouseWheelScroll.x, event.mouseWheelScroll.y);
+                auto anchor = window.mapPixelToCoords(pixel, camera);
+                float next = zoom * std::pow(ZOOM_STEP, -event.mouseWheelScroll.delta);
+                next = std::clamp(next, MIN_ZOOM, MAX_ZOOM);
+                camera.zoom(next / zoom);
+                zoom = next;
+                camera.move(anchor - window.mapPixelToCoords(pixel, camera));
+            }
+            if (event.type == sf::Event::MouseButtonPressed &&
+                event.mouseButton.button == sf::Mouse::Middle)
+            {
+                panning = true;
+                panFrom = {event.mouseButton.x, event.mouseButton.y};
+            }
+            if (event.type == sf::Event::MouseButtonReleased &&
+                event.mouseButton.button == sf::Mouse::Middle)
+            {
+                panning = false;
+            }
+            if (panning && event.type == sf::Event::MouseMoved)
+            {
+                sf::Vector2i to(event.mouseMove.x, event.mouseMove.y);
+                camera.move(window.mapPixelToCoords(panFrom, camera) -
+                            window.mapPixelToCoords(to, camera));
+                panFrom = to;
+            }
+
+            // всё, что меняет или читает граф, - под блокировкой потока физики
+            PhysicsThread::Lock guard;
+            if (event.type == sf::Event::MouseButtonPressed || event.type == sf::Event::KeyPressed)
+                guard = physics.lock();
+            int selectedNodeId = graph.core.nodeId(selectedNode);
+            int selectedEdgeId = graph.core.edgeId(selectedEdge);
+            int pathStartId = graph.core.nodeId(pathStart);
+
             if (event.type == sf::Event::MouseButtonPressed &&
                 event.mouseButton.button == sf::Mouse::Left)
             {
-                sf::Vector2f click(event.mouseButton.x, event.mouseButton.y);
+                sf::Vector2i pixel(event.mouseButton.x, event.mouseButton.y);
+                auto click = window.mapPixelToCoords(pixel, camera);
 
                 // кнопка Clear
-                if (clearBtn.getGlobalBounds().contains(click))
+                if (clearBtn.getGlobalBounds().contains((sf::Vector2f) pixel))
                 {
                     graph.clear();
-                    draggedNodeId = -1;
-                    selectedNodeId = -1;
-                    selectedEdgeId = -1;
+                    draggedNode = {};
+                    selectedNode = {};
+                    selectedEdge = {};
+                    pathStart = {};
                     typingWeight = false;
                     weightInput.clear();
                     continue;
@@ -57,97 +160,188 @@ int main()
                 bool clickedNode = false;
 
                 // проверяем клик по вершине
-                for (int i = 0; i < (int) graph.nodes.size(); i++)
+                int i = graph.pickNode(click);
+                if (i != -1)
                 {
-                    float dx = click.x - graph.nodes[i].position.x;
-                    float dy = click.y - graph.nodes[i].position.y;
-                    float dist = std::sqrt(dx * dx + dy * dy);
-                    if (dist <= graph.nodes[i].radius)
-                    {
-                        typingWeight = false;
-                        selectedEdgeId = -1;
-                        weightInput.clear();
+                    typingWeight = false;
+                    selectedEdge = {};
+                    weightInput.clear();
 
-                        if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl))
-                        {
-                            // соединение вершин
-                            if (selectedNodeId == -1)
-                            {
-                                selectedNodeId = i;
-                                graph.nodes[i].shape.setFillColor(sf::Color::Yellow);
-                                for (auto& edge : graph.edges)
-                                    edge.IsSelected =
-                                        (edge.firstNodeId == i || edge.secondNodeId == i);
-                            }
-                            else
-                            {
-                                graph.addEdge(selectedNodeId, i);
-                                graph.nodes[selectedNodeId].shape.setFillColor(
-                                    sf::Color(100, 150, 250));
-                                selectedNodeId = -1;
-                                for (auto& edge : graph.edges) edge.IsSelected = false;
-                            }
-                        }
-                        else if (sf::Keyboard::isKeyPressed(sf::Keyboard::LShift))
+                    if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl))
+                    {
+                        // соединение вершин
+                        if (selectedNodeId == -1)
                         {
-                            // создаём соседнюю вершину
-                            float angle = (float) rand() / RAND_MAX * 2 * M_PI;
-                            graph.addNode(graph.nodes[i].position +
-                                              sf::Vector2f(60 * cos(angle), 60 * sin(angle)),
-                                          font);
-                            graph.addEdge(i, (int) graph.nodes.size() - 1);
+                            selectedNode = graph.core.nodeHandle(i);
+                            graph.setNodeColor(i, sf::Color::Yellow);
+                            graph.selectIncidentEdges(i);
                         }
                         else
                         {
-                            // перетаскивание вершины
-                            draggedNodeId = i;
-                            for (auto& edge : graph.edges)
-                                edge.IsSelected = (edge.firstNodeId == i || edge.secondNodeId == i);
+                            graph.addEdge(selectedNodeId, i);
+                            graph.setNodeColor(selectedNodeId, NODE_COLOR);
+                            selectedNode = {};
+                            graph.clearSelection();
                         }
-
-                        clickedNode = true;
-                        break;
                     }
+                    else if (sf::Keyboard::isKeyPressed(sf::Keyboard::LShift))
+                    {
+                        // создаём соседнюю вершину
+                        float angle = (float) rand() / RAND_MAX * 2 * M_PI;
+                        graph.addNode(graph.position(i) +
+                                      sf::Vector2f(60 * cos(angle), 60 * sin(angle)));
+                        graph.addEdge(i, (int) graph.nodes.size() - 1);
+                    }
+                    else
+                    {
+                        // перетаскивание вершины
+                        draggedNode = graph.core.nodeHandle(i);
+                        graph.selectIncidentEdges(i);
+                    }
+
+                    clickedNode = true;
                 }
 
                 if (!clickedNode)
                 {
                     // клик по ребру?
                     bool edgeClicked = false;
-                    for (int i = 0; i < (int) graph.edges.size(); i++)
+                    int edgeId = graph.pickEdge(click, EDGE_PICK_PIXELS * zoom);
+                    if (edgeId != -1)
                     {
-                        auto& edge = graph.edges[i];
-                        if (isPointNearLine(click, graph.nodes[edge.firstNodeId].position,
-                                            graph.nodes[edge.secondNodeId].position))
-                        {
-                            for (auto& ee : graph.edges) ee.IsSelected = false;
-                            selectedNodeId = -1;
-                            draggedNodeId = -1;
-
-                            selectedEdgeId = i;
-                            edge.IsSelected = true;
-                            typingWeight = true;
-                            weightInput.clear();
-                            edgeClicked = true;
-                            break;
-                        }
+                        graph.clearSelection();
+                        selectedNode = {};
+                        draggedNode = {};
+
+                        selectedEdge = graph.core.edgeHandle(edgeId);
+                        graph.setEdgeSelected(edgeId, true);
+                        typingWeight = true;
+                        weightInput.clear();
+                        edgeClicked = true;
                     }
 
                     if (!edgeClicked)
                     {
                         typingWeight = false;
-                        selectedEdgeId = -1;
+                        selectedEdge = {};
                         weightInput.clear();
-                        graph.addNode(click, font);
-                        for (auto& edge : graph.edges) edge.IsSelected = false;
+                        graph.addNode(click);
+                        graph.clearSelection();
                     }
                 }
             }
 
+            // кратчайший путь: правый клик по начальной вершине, затем по конечной
+            if (event.type == sf::Event::MouseButtonPressed &&
+                event.mouseButton.button == sf::Mouse::Right)
+            {
+                int i = graph.pickNode(
+                    window.mapPixelToCoords({event.mouseButton.x, event.mouseButton.y}, camera));
+                typingWeight = false;
+                selectedEdge = {};
+                weightInput.clear();
+                graph.clearSelection();
+                if (pathStartId != -1) graph.setNodeColor(pathStartId, NODE_COLOR);
+
+                if (i != -1 && pathStartId == -1)
+                {
+                    pathStart = graph.core.nodeHandle(i);
+                    graph.setNodeColor(i, sf::Color::Green);
+                }
+                else
+                {
+                    if (i != -1) graph.core.shortestPath(pathStartId, i, path);
+                    graph.selectEdges(path);
+                    path.clear();
+                    pathStart = {};
+                }
+            }
+
             if (event.type == sf::Event::MouseButtonReleased &&
                 event.mouseButton.button == sf::Mouse::Left)
             {
-                draggedNodeId = -1;
+                draggedNode = {};
+            }
+
+            // переключение режима раскладки
+            if (!typingWeight && event.type == sf::Event::KeyPressed &&
+                event.key.code == sf::Keyboard::L)
+            {
+                graph.core.layoutMode = graph.core.layoutMode == LayoutMode::Overlap
+                                            ? LayoutMode::BarnesHut
+                                            : LayoutMode::Overlap;
+                graph.core.wakeAll();
+            }
+
+            // следующая модель сил (ForceModel.hpp): F
+            if (!typingWeight && event.type == sf::Event::KeyPressed &&
+                event.key.code == sf::Keyboard::F)
+            {
+                const auto& models = GraphCore::forceModels();
+                auto found = std::find_if(models.begin(), models.end(), [&](const auto& model) {
+                    return model.name == std::string(graph.core.forceModelName());
+                });
+                graph.core.setForceModel(models[(found - models.begin() + 1) % models.size()].name);
+            }
+
+            // раскладка с нуля через огрубление графа: R
+            if (!typingWeight && event.type == sf::Event::KeyPressed &&
+                event.key.code == sf::Keyboard::R && !layouter.joinable())
+            {
+                graph.core.snapshotLayout(layoutJob);
+                layoutFinished = false;
+                layouter = std::thread([&, threads = graph.core.threadCount] {
+                    ThreadPool pool(threads);
+                    layoutJob.run(pool);
+                    layoutFinished.store(true, std::memory_order_release);
+                });
+            }
+
+            // подсветка минимального остовного леса: M
+            if (!typingWeight && event.type == sf::Event::KeyPressed &&
+                event.key.code == sf::Keyboard::M)
+            {
+                graph.core.minimumSpanningForest(path);
+                graph.selectEdges(path);
+                path.clear();
+            }
+
+            // удаление вершины (вместе с рёбрами) или ребра под курсором: Delete
+            if (!typingWeight && event.type == sf::Event::KeyPressed &&
+                event.key.code == sf::Keyboard::Delete)
+            {
+                auto point = window.mapPixelToCoords(sf::Mouse::getPosition(window), camera);
+                int i = graph.pickNode(point);
+                int edgeId = i == -1 ? graph.pickEdge(point, EDGE_PICK_PIXELS * zoom) : -1;
+                if (i != -1) graph.removeNode(i);
+                if (edgeId != -1) graph.removeEdge(edgeId);
+                continue;
+            }
+
+            if (!typingWeight && event.type == sf::Event::KeyPressed &&
+                event.key.code == sf::Keyboard::P)
+            {
+                profiler.setEnabled(!profiler.enabled());
+            }
+            if (!typingWeight && event.type == sf::Event::KeyPressed &&
+                event.key.code == sf::Keyboard::T)
+            {
+                profiler.exportTrace("trace.json");
+            }
+
+            // сохранение и загрузка графа: S / O
+            if (!typingWeight && event.type == sf::Event::KeyPressed &&
+                event.key.code == sf::Keyboard::S)
+            {
+                graph.save("graph.bin");
+            }
+            if (!typingWeight && event.type == sf::Event::KeyPressed &&
+                event.key.code == sf::Keyboard::O && graph.load("graph.bin"))
+            {
+                draggedNode = {};
+                selectedNode = {};
+                selectedEdge = {};
+                pathStart = {};
             }
 
             if (typingWeight && selectedEdgeId != -1 && event.type == sf::Event::TextEntered)
@@ -169,18 +363,18 @@ int main()
                 {
                     if (!weightInput.empty())
                     {
-                        graph.edges[selectedEdgeId].weight = std::stof(weightInput);
+                        graph.setEdgeWeight(selectedEdgeId, std::stof(weightInput));
                     }
                     typingWeight = false;
-                    graph.edges[selectedEdgeId].IsSelected = false;
-                    selectedEdgeId = -1;
+                    graph.setEdgeSelected(selectedEdgeId, false);
+                    selectedEdge = {};
                 }
                 else if (event.key.code == sf::Keyboard::Escape)
                 {
                     typingWeight = false;
                     weightInput.clear();
-                    graph.edges[selectedEdgeId].IsSelected = false;
-                    selectedEdgeId = -1;
+                    graph.setEdgeSelected(selectedEdgeId, false);
+                    selectedEdge = {};
                 }
                 else if (event.key.code == sf::Keyboard::BackSpace)
                 {
@@ -189,18 +383,67 @@ int main()
             }
         }
 
-        if (draggedNodeId != -1)
+        eventsScope.finish();
+
+        if (importer.joinable())
+        {
+            if (importProgress.finished.load(std::memory_order_acquire))
+            {
+                importer.join();
+                auto guard = physics.lock();
+                if (importOk) graph.importGraph(imported);
+                importText.setString(importOk ? "" : "Import failed: " + imported.error);
+                imported = ImportedGraph();
+                draggedNode = {};
+                selectedNode = {};
+                selectedEdge = {};
+                pathStart = {};
+            }
+            else
+            {
+                auto percent = (int) (importProgress.fraction() * 100);
+                importText.setString("Importing " + std::to_string(percent) + "%");
+            }
+        }
+
+        if (layouter.joinable() && layoutFinished.load(std::memory_order_acquire))
         {
-            graph.nodes[draggedNodeId].position = (sf::Vector2f) sf::Mouse::getPosition(window);
+            layouter.join();
+            auto guard = physics.lock();
+            graph.core.applyLayout(layoutJob);
+            layoutJob = GraphCore::LayoutJob();
         }
 
-        graph.updatePhysics(draggedNodeId);
-        graph.updateNodes();
+        // состояние перетаскивания уходит в физику каждый кадр, так что
+        // отпускание не теряется, даже если очередь была полна
+        auto mouse = window.mapPixelToCoords(sf::Mouse::getPosition(window), camera);
+        physics.drag(draggedNode, mouse.x, mouse.y);
+
+        {
+            FrameProfiler::Scope scope(&profiler, Phase::UpdateNodes);
+            graph.updateNodes(physics.latestFrame());
+            graph.setDraggedNode(graph.core.nodeId(draggedNode));
+        }
 
         window.clear(sf::Color::Black);
-        graph.draw(window, font, typingWeight ? selectedEdgeId : -1, weightInput);
+        window.setView(camera);
+        {
+            FrameProfiler::Scope scope(&profiler, Phase::Draw);
+            graph.draw(window, font, typingWeight ? graph.core.edgeId(selectedEdge) : -1,
+                       weightInput);
+        }
+        window.setView(screen);
         window.draw(clearBtn);
         window.draw(btnText);
-        window.display();
+        window.draw(importText);
+        if (profiler.enabled()) profilerOverlay.draw(window, font, profiler);
+        {
+            FrameProfiler::Scope scope(&profiler, Phase::Display);
+            window.display();
+        }
     }
+
+    importProgress.cancel = true;
+    if (importer.joinable()) importer.join();
+    if (layouter.joinable()) layouter.join();
 }